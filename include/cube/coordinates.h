@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "state.h"
+#include "move.h"
+#include "tablefile.h"
+
+namespace rubik
+{
+	/**********************************************************************
+	 * A coordinate is a small integer describing one aspect of a cube
+	 * state (orientations, positions of a group of cubies, ...). The
+	 * metrics of every phase of the thistlethwaite-kociemba algorithm are
+	 * made of these coordinates, which means that the metrics of a child
+	 * can be found with a single table lookup per coordinate instead of
+	 * turning the cubies and scanning them again.
+	 **********************************************************************/
+
+	enum Coordinate
+	{
+		CORNER_TWIST = 0,
+		EDGE_FLIP = 1,
+		SLICE_COMBINATION = 2,
+		SIDE_CENTER_PARITY = 3,
+		EDGE_TETRAD = 4,
+		CORNER_TETRAD = 5,
+		CORNER_PARITY = 6,
+		CORNER_PERMUTATION = 7,
+		EDGE_PERMUTATION = 8,
+		SLICE_PERMUTATION = 9,
+		UD_CENTER_PARITY = 10,
+		COORDINATE_COUNT = 11,
+	};
+
+	/*
+	Number of values each coordinate can take.
+	*/
+	const unsigned int COORDINATE_SIZES[] = {
+		2187,  // 3^7 corner orientations
+		2048,  // 2^11 edge orientations
+		495,   // 12 choose 4 positions of the middle slice edges
+		16,	   // 2^4 parities of the F, B, L and R centers
+		495,   // 12 choose 4 positions of the UR, UL, DR and DL edges
+		2520,  // 8! / 2!^4 placements of the corner pairs
+		2,	   // parity of the corner permutation
+		40320, // 8! corner permutations
+		40320, // 8! top and bottom edge permutations
+		24,	   // 4! middle slice edge permutations
+		4,	   // 2^2 parities of the U and D centers
+	};
+
+	const char *const COORDINATE_NAMES[] = {
+		"corner_twist",
+		"edge_flip",
+		"slice_combination",
+		"side_center_parity",
+		"edge_tetrad",
+		"corner_tetrad",
+		"corner_parity",
+		"corner_permutation",
+		"edge_permutation",
+		"slice_permutation",
+		"ud_center_parity",
+	};
+
+	/*
+	Value stored for moves that would take a coordinate out of its domain.
+	*/
+	const uint16_t INVALID_COORDINATE = 0xFFFF;
+
+	/*
+	Coordinates making up the four metrics of each phase.
+	*/
+	constexpr Coordinate PHASE_COORDINATES[][4] = {
+		{CORNER_TWIST, SLICE_COMBINATION, EDGE_FLIP, SIDE_CENTER_PARITY},
+		{EDGE_TETRAD, CORNER_TETRAD, CORNER_PARITY, COORDINATE_COUNT},
+		{CORNER_PERMUTATION, EDGE_PERMUTATION, SLICE_PERMUTATION, UD_CENTER_PARITY},
+	};
+
+	uint16_t cornerTwist(const CubeState &state);
+	uint16_t edgeFlip(const CubeState &state);
+	uint16_t sliceCombination(const CubeState &state);
+	uint16_t sideCenterParity(const CubeState &state);
+	uint16_t edgeTetrad(const CubeState &state);
+	uint16_t cornerTetrad(const CubeState &state);
+	uint16_t cornerParity(const CubeState &state);
+	uint16_t cornerPermutation(const CubeState &state);
+	uint16_t edgePermutation(const CubeState &state);
+	uint16_t slicePermutation(const CubeState &state);
+	uint16_t udCenterParity(const CubeState &state);
+
+	uint16_t computeCoordinate(Coordinate coordinate, const CubeState &state);
+
+	/*
+	Lookup tables for the kernels that find sets of cubies with vector compares:
+	the rank of every set of edge positions (bit e for position e) as given by
+	sliceCombination and edgeTetrad, and the corner tetrad of every placement
+	of the corner pairs (2 bits per corner position).
+	*/
+	const uint16_t *getCombinationRanks();
+	const uint16_t *getCornerTetrads();
+
+	/**
+	 * Transition tables (coordinate, move) -> coordinate for every coordinate.
+	 * Mapped from the table files on first use, or built by exploring each
+	 * coordinate space from the solved state.
+	 */
+	class MoveTables
+	{
+		std::array<MappedTable, COORDINATE_COUNT> _files;
+		std::array<const uint16_t *, COORDINATE_COUNT> _tables;
+
+	public:
+		static const MoveTables &getInstance();
+
+		uint16_t apply(Coordinate coordinate, uint16_t value, const Move &move) const
+		{
+			return _tables[coordinate][value * NUM_POSSIBLE_MOVES + move.code()];
+		}
+
+		TKMetrics applyMove(unsigned int phase, const TKMetrics &metrics, const Move &move) const;
+
+		/**
+		 * Metrics of a child from the metrics of its parent, one lookup per coordinate.
+		 * Only valid for the moves of the phase, which keep every coordinate in its domain.
+		 * @param metrics - metrics of the parent
+		 * @param move - move applied to the parent
+		 */
+		template <unsigned int Phase>
+		TKMetrics updateMetrics(const TKMetrics &metrics, const Move &move) const
+		{
+			const Coordinate *coordinates = PHASE_COORDINATES[Phase];
+			TKMetrics child = metrics;
+
+			child.m1 = apply(coordinates[0], metrics.m1, move);
+			child.m2 = apply(coordinates[1], metrics.m2, move);
+			child.m3 = apply(coordinates[2], metrics.m3, move);
+			if constexpr (PHASE_COORDINATES[Phase][3] != COORDINATE_COUNT)
+				child.m4 = apply(coordinates[3], metrics.m4, move);
+
+			return child;
+		}
+
+		const uint16_t *getTable(Coordinate coordinate) const;
+
+	private:
+		MoveTables();
+	};
+}
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <queue>
 #include <vector>
 #include <glm/vec2.hpp>
 
 #include "model.h"
 #include "state.h"
 #include "move.h"
+#include "solver.h"
+#include "solverjob.h"
 
 namespace rubik
 {
@@ -14,8 +20,15 @@ namespace rubik
 		CubeModel _model;
 		CubeState _state;
 		CubeType _type;
-		bool _solving = false;
 		bool _centerOrientation;
+		SolverOptions _solverOptions;
+
+		// Moves found by the solver job, turned by the thread calling update
+		std::mutex _solvedMovesMutex;
+		std::queue<Move> _solvedMoves;
+		std::unique_ptr<SolverJob> _job;
+		// Length of the best solution of the near-optimal job so far, 0 before the first one
+		std::atomic<unsigned int> _bestLength;
 
 	public:
 		Cube(CubeType type);
@@ -25,10 +38,22 @@ namespace rubik
 		void turnFace(const Move move);
 		void turnCube(glm::vec2 delta);
 		void solve();
+		void cancelSolve();
 		bool isSolving();
+		unsigned int getBestLength() const;
 		void mix();
 		void changeType(CubeType newType);
+		void setSolverEngine(SolverEngine engine);
+		SolverEngine getSolverEngine() const;
+		void setSearchThreads(unsigned int threads);
+		unsigned int getSearchThreads() const;
+		void setTimeLimit(double seconds);
+		double getTimeLimit() const;
 
 		friend std::ostream &operator<<(std::ostream &s, const Cube &cube);
+
+	private:
+		void turnSolvedMoves();
+		void finishSolve();
 	};
 }
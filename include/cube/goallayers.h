@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "phasesearch.h"
+#include "state.h"
+#include "tablefile.h"
+#include "visitedtable.h"
+
+namespace rubik
+{
+	/*
+	State of the goal side of a phase: packed metrics (see packMetrics), moves to the
+	goal and the first move of a shortest way there.
+	*/
+	struct GoalEntry
+	{
+		uint64_t key;
+		uint8_t depth;
+		uint8_t move;
+		// Zeroed so that the table files are the same from one build to the next
+		uint8_t padding[6];
+	};
+
+	// Key of the free slots, no metrics pack to it
+	const uint64_t EMPTY_GOAL_KEY = ~uint64_t(0);
+
+	/**
+	 * Every state of a phase at most a few moves from its goal, found once by a
+	 * breadth-first search from the solved state. The searches of every solve then
+	 * start their backward side from the deepest layer instead of the goal.
+	 * Read-only open-addressing (linear probing) table, mapped from its file.
+	 */
+	class GoalLayers
+	{
+		MappedTable _file;
+		const GoalEntry *_entries;
+		size_t _mask;
+		size_t _size;
+		// States of the deepest layer, where the backward searches resume
+		std::vector<CoordinateNode> _frontier;
+
+	public:
+		static const GoalLayers &getInstance(unsigned int phase, unsigned int depth);
+
+		/**
+		 * @param metrics - metrics of a state of the phase
+		 * @return the entry of the state, nullptr if it is farther from the goal than the table
+		 */
+		const GoalEntry *find(const TKMetrics &metrics) const
+		{
+			const uint64_t key = packMetrics(metrics);
+			size_t index = hashMetricsKey(key) & _mask;
+
+			while (_entries[index].key != EMPTY_GOAL_KEY)
+			{
+				if (_entries[index].key == key)
+					return &_entries[index];
+
+				index = (index + 1) & _mask;
+			}
+
+			return nullptr;
+		}
+
+		const std::vector<CoordinateNode> &frontier() const;
+		size_t size() const;
+		size_t bytes() const;
+
+	private:
+		GoalLayers(unsigned int phase, unsigned int depth);
+	};
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+#include "coordinates.h"
+#include "tablefile.h"
+#include "solver.h"
+#include "state.h"
+#include "move.h"
+
+namespace rubik
+{
+	const static unsigned int KOCIEMBA_MAX_PHASE1_LENGTH = 12;
+	const static unsigned int KOCIEMBA_MAX_PHASE2_LENGTH = 18;
+
+	/*
+	Value of a pruning table entry that was never reached.
+	*/
+	const uint8_t UNREACHED_DEPTH = 0xFF;
+
+	/**
+	 * Pruning tables of the two-phase algorithm. Each entry is the exact number of moves
+	 * needed to solve a pair of coordinates, which is a lower bound for the whole phase.
+	 *	- Phase 1: (corner twist, slice combination) and (edge flip, slice combination)
+	 *	- Phase 2: (corner permutation, slice permutation) and (edge permutation, slice permutation)
+	 */
+	class KociembaTables
+	{
+		MappedTable _files[4];
+
+		const uint8_t *_twistSlice;
+		const uint8_t *_flipSlice;
+		const uint8_t *_cornerSlice;
+		const uint8_t *_edgeSlice;
+
+	public:
+		static const KociembaTables &getInstance();
+
+		uint8_t twistSlice(uint16_t twist, uint16_t slice) const
+		{
+			return _twistSlice[twist * COORDINATE_SIZES[SLICE_COMBINATION] + slice];
+		}
+
+		uint8_t flipSlice(uint16_t flip, uint16_t slice) const
+		{
+			return _flipSlice[flip * COORDINATE_SIZES[SLICE_COMBINATION] + slice];
+		}
+
+		uint8_t cornerSlice(uint16_t corners, uint16_t slice) const
+		{
+			return _cornerSlice[corners * COORDINATE_SIZES[SLICE_PERMUTATION] + slice];
+		}
+
+		uint8_t edgeSlice(uint16_t edges, uint16_t slice) const
+		{
+			return _edgeSlice[edges * COORDINATE_SIZES[SLICE_PERMUTATION] + slice];
+		}
+
+	private:
+		KociembaTables();
+	};
+
+	std::queue<Move> kociemba(CubeState problem, unsigned int maxLength = 30, SolveReport *report = nullptr,
+							  const SearchLimits &limits = SearchLimits());
+}
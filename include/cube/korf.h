@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <queue>
+
+#include "coordinates.h"
+#include "tablefile.h"
+#include "solver.h"
+#include "state.h"
+#include "move.h"
+
+namespace rubik
+{
+	// No position of the cube needs more moves (God's number in the face turn metric)
+	const static unsigned int KORF_MAX_LENGTH = 20;
+
+	// Edges of each edge pattern: cubies 0 to 5 for the first one, 6 to 11 for the second one
+	const static unsigned int EDGE_PATTERN_CUBIES = 6;
+
+	// (corner permutation, corner twist): 8! * 3^7
+	const static uint32_t CORNER_PATTERN_SIZE = 40320 * 2187;
+	// (positions of 6 edges, their flips): 12! / 6! * 2^6
+	const static uint32_t EDGE_PATTERN_SIZE = 665280 * 64;
+
+	// Value of a pattern database entry that was never reached
+	const static uint8_t UNREACHED_PATTERN = 0xF;
+
+	/**
+	 * Position and flip of every edge cubie, the edge part of a state as the edge
+	 * pattern databases index it.
+	 */
+	struct EdgePlacement
+	{
+		uint8_t position[NUM_EDGES];
+		uint8_t flip[NUM_EDGES];
+	};
+
+	EdgePlacement edgePlacement(const CubeState &state);
+	uint32_t edgePatternIndex(const uint8_t *position, const uint8_t *flip);
+
+	/**
+	 * Pattern databases of Korf's optimal solver, 4 bits per entry. Each entry is the
+	 * exact number of moves needed to solve a part of the cube, so the largest of the
+	 * three is a lower bound for the whole cube.
+	 *	- Corners: (corner permutation, corner twist)
+	 *	- Edges: (positions, flips) of edges 0 to 5 and of edges 6 to 11
+	 */
+	class PatternDatabases
+	{
+		MappedTable _files[3];
+
+		const uint8_t *_corners;
+		const uint8_t *_edges[2];
+
+	public:
+		static const PatternDatabases &getInstance();
+
+		/**
+		 * @param index - (corner permutation, corner twist) index
+		 */
+		uint8_t corners(uint32_t index) const
+		{
+			return entry(_corners, index);
+		}
+
+		/**
+		 * @param half - 0 for the edges 0 to 5, 1 for the edges 6 to 11
+		 * @param index - (positions, flips) index of the edges of the half
+		 */
+		uint8_t edges(unsigned int half, uint32_t index) const
+		{
+			return entry(_edges[half], index);
+		}
+
+		/**
+		 * @param table - entries packed by two, the even index in the low half of a byte
+		 * @param index - entry to read
+		 */
+		static uint8_t entry(const uint8_t *table, uint32_t index)
+		{
+			return (table[index >> 1] >> ((index & 1) * 4)) & 0xF;
+		}
+
+	private:
+		PatternDatabases();
+	};
+
+	std::queue<Move> korf(CubeState problem, ThreadPool &pool, SolveReport *report = nullptr,
+						  const SearchLimits &limits = SearchLimits());
+	std::queue<Move> korf(CubeState problem, unsigned int threads = 0, SolveReport *report = nullptr,
+						  const SearchLimits &limits = SearchLimits());
+}
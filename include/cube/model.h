@@ -80,5 +80,7 @@ namespace rubik
 
 	private:
 		void addTargets();
+		static glm::vec4 toAxisAngle(const Move &move);
+		static bool affectsPiece(const Move &move, const std::vector<glm::vec3> &normals);
 	};
 }
@@ -1,13 +1,7 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
-#include <vector>
-#include <glm/vec3.hpp>
-#include <glm/vec4.hpp>
-
-#define _USE_MATH_DEFINES
-
-#include <math.h>
 
 namespace rubik
 {
@@ -66,10 +60,6 @@ namespace rubik
 
 		MoveAxis getAxis() const;
 
-		glm::vec4 toAxisAngle() const;
-
-		bool affectsPiece(const std::vector<glm::vec3> normals) const;
-
 		friend std::ostream &operator<<(std::ostream &s, const Move &move);
 	};
 }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <queue>
+
+#include "phasesearch.h"
+#include "solver.h"
+#include "state.h"
+#include "move.h"
+
+namespace rubik
+{
+	// Moves of the first phases searched before switching to a job per prefix
+	const static unsigned int NEAR_OPTIMAL_SPLIT_DEPTH = 2;
+
+	std::queue<Move> nearOptimal(CubeState problem, const SolverOptions &options, ThreadPool &pool,
+								 SolveReport *report = nullptr, const SearchLimits &limits = SearchLimits());
+	std::queue<Move> nearOptimal(CubeState problem, const SolverOptions &options, SolveReport *report = nullptr,
+								 const SearchLimits &limits = SearchLimits());
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "phasesearch.h"
+#include "threadpool.h"
+#include "state.h"
+#include "move.h"
+
+namespace rubik
+{
+	/**
+	 * IDA* shared by the workers of a thread pool. Every iteration is split into the pruned
+	 * move prefixes of a few moves, searched depth-first as the jobs of the pool so that
+	 * idle workers steal the remaining subtrees. The search deriving from it gives the
+	 * nodes and the bound, and decides what happens when the bound is reached:
+	 *	- Node child(const Node &node, const Move &move) const
+	 *	- bool prune(const Node &node, unsigned int togo) const, if no path of togo moves
+	 *	  from the node can reach the goal
+	 *	- bool reached(const Node &node, const Move *path, unsigned int length, unsigned int worker),
+	 *	  called when a path meets the bound without being pruned, returns if the iteration must end
+	 * @tparam SplitDepth - moves of the prefixes searched before switching to a job per prefix
+	 */
+	template <typename Derived, typename Node, unsigned int SplitDepth>
+	class ParallelIdaSearch
+	{
+		struct Prefix
+		{
+			Node node;
+			Move path[SplitDepth];
+			unsigned int length;
+			int lastFace;
+		};
+
+		const SearchLimits &_limits;
+		std::vector<Prefix> _prefixes;
+		// Path of the current job of every worker, kept between the iterations
+		std::vector<std::vector<Move>> _paths;
+
+	protected:
+		// Set once the iteration must end or the limits were reached, every worker then returns
+		std::atomic<bool> _done;
+		std::atomic<bool> _stopped;
+		std::atomic<uint64_t> _nodes;
+
+	public:
+		explicit ParallelIdaSearch(const SearchLimits &limits)
+			: _limits(limits), _done(false), _stopped(false), _nodes(0) {}
+
+		uint64_t nodes() const
+		{
+			return _nodes;
+		}
+
+		/**
+		 * @return if the limits or the search itself stopped it before its end
+		 */
+		bool stopped() const
+		{
+			return _stopped;
+		}
+
+	protected:
+		/**
+		 * Run the iterations with increasing bounds until the limits are reached or the
+		 * stop rule ends the search.
+		 * @param pool - threads sharing the subtrees of every iteration
+		 * @param root - node of the problem
+		 * @param threshold - bound of the first iteration
+		 * @param proceed - stop rule, takes the bound of the next iteration and returns if it must run
+		 */
+		template <typename Proceed>
+		void iterate(ThreadPool &pool, const Node &root, unsigned int threshold, Proceed proceed)
+		{
+			_paths.resize(pool.size());
+
+			for (; !_stopped && proceed(threshold); threshold++)
+			{
+				_prefixes.clear();
+				_done = false;
+
+				uint64_t prefixNodes = 0;
+				gather(Prefix{root, {}, 0, -1}, threshold, std::min(threshold, SplitDepth), prefixNodes);
+				_nodes += prefixNodes;
+
+				pool.run(_prefixes.size(), [&](size_t job, unsigned int worker)
+						 {
+					const Prefix &start = _prefixes[job];
+					std::vector<Move> &path = _paths[worker];
+					path.resize(threshold);
+					std::copy(start.path, start.path + start.length, path.begin());
+
+					uint64_t nodes = 0;
+					search(start.node, start.length, threshold - start.length, start.lastFace, path.data(), nodes,
+						   worker);
+					_nodes += nodes & 0xFFF; });
+			}
+		}
+
+		/**
+		 * End the current iteration and start no other one.
+		 */
+		void stop()
+		{
+			_stopped = true;
+			_done = true;
+		}
+
+	private:
+		Derived &derived()
+		{
+			return static_cast<Derived &>(*this);
+		}
+
+		/**
+		 * Collect the nodes of the given depth that the bound does not prune.
+		 */
+		void gather(const Prefix &prefix, unsigned int threshold, unsigned int depth, uint64_t &nodes)
+		{
+			nodes++;
+
+			if (derived().prune(prefix.node, threshold - prefix.length))
+				return;
+
+			if (prefix.length == depth)
+			{
+				_prefixes.push_back(prefix);
+				return;
+			}
+
+			const MoveList &moves = CANONICAL_MOVE_LISTS<ALL_MOVES>[prefix.lastFace + 1];
+
+			for (uint8_t i = 0; i < moves.size; i++)
+			{
+				Move move(moves.moves[i]);
+				Prefix next = prefix;
+				next.node = derived().child(prefix.node, move);
+				next.path[next.length++] = move;
+				next.lastFace = move.getFace();
+
+				gather(next, threshold, depth, nodes);
+			}
+		}
+
+		/**
+		 * Check the limits every few thousand nodes of a worker.
+		 * @param nodes - nodes of the worker in this job
+		 * @return if the search must stop
+		 */
+		bool checkLimits(uint64_t nodes)
+		{
+			if ((nodes & 0xFFF) == 0)
+			{
+				uint64_t total = _nodes += 0x1000;
+				if (_limits.reached(total))
+					stop();
+			}
+
+			return _done.load(std::memory_order_relaxed);
+		}
+
+		void search(const Node &node, unsigned int depth, unsigned int togo, int lastFace, Move *path,
+					uint64_t &nodes, unsigned int worker)
+		{
+			if (checkLimits(++nodes))
+				return;
+
+			if (derived().prune(node, togo))
+				return;
+
+			if (togo == 0)
+			{
+				if (derived().reached(node, path, depth, worker))
+					_done = true;
+				return;
+			}
+
+			const MoveList &moves = CANONICAL_MOVE_LISTS<ALL_MOVES>[lastFace + 1];
+
+			for (uint8_t i = 0; i < moves.size; i++)
+			{
+				Move move(moves.moves[i]);
+				path[depth] = move;
+
+				search(derived().child(node, move), depth + 1, togo - 1, move.getFace(), path, nodes, worker);
+				if (_done.load(std::memory_order_relaxed))
+					return;
+			}
+		}
+	};
+}
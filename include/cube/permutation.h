@@ -0,0 +1,174 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace rubik
+{
+	/**********************************************************************
+	 * Ranking of the permutations and combinations behind the coordinates.
+	 * Sets of values and positions are bitmasks, so that counting the
+	 * larger values already seen is a bit count and every rank or
+	 * unrank is a single pass over the elements.
+	 *
+	 * The permutation rank is the Lehmer code sum(c_i * i!), where c_i is
+	 * the number of elements before position i that are larger than the
+	 * element at position i. The combination rank is colexicographic:
+	 * sum(C(p_k, k)) over the k-th marked position p_k, from k = 1.
+	 **********************************************************************/
+
+	// Largest number of elements of a ranked permutation or combination
+	const static unsigned int MAX_RANKED_ELEMENTS = 12;
+
+	constexpr std::array<uint32_t, MAX_RANKED_ELEMENTS + 1> FACTORIALS = []()
+	{
+		std::array<uint32_t, MAX_RANKED_ELEMENTS + 1> factorials{1};
+		for (unsigned int i = 1; i <= MAX_RANKED_ELEMENTS; i++)
+			factorials[i] = factorials[i - 1] * i;
+		return factorials;
+	}();
+
+	constexpr std::array<std::array<uint16_t, MAX_RANKED_ELEMENTS + 1>, MAX_RANKED_ELEMENTS + 1> BINOMIALS = []()
+	{
+		std::array<std::array<uint16_t, MAX_RANKED_ELEMENTS + 1>, MAX_RANKED_ELEMENTS + 1> binomials{};
+		for (unsigned int n = 0; n <= MAX_RANKED_ELEMENTS; n++)
+		{
+			binomials[n][0] = 1;
+			for (unsigned int k = 1; k <= n; k++)
+				binomials[n][k] = binomials[n - 1][k - 1] + (k < n ? binomials[n - 1][k] : 0);
+		}
+		return binomials;
+	}();
+
+	// Bits set in every 11-bit number
+	constexpr std::array<uint8_t, 1 << 11> BIT_COUNTS = []()
+	{
+		std::array<uint8_t, 1 << 11> counts{};
+		for (unsigned int i = 0; i < counts.size(); i++)
+			counts[i] = std::popcount(i);
+		return counts;
+	}();
+
+	/**
+	 * Bits set in the 22 low bits of a mask. Two lookups beat std::popcount when the
+	 * target has no popcnt instruction and the count is emulated.
+	 */
+	inline unsigned int bitCount(uint32_t mask)
+	{
+		return BIT_COUNTS[mask & 0x7FF] + BIT_COUNTS[(mask >> 11) & 0x7FF];
+	}
+
+	/**
+	 * @return n choose k, or 0 if k > n
+	 */
+	constexpr uint16_t binomial(unsigned int n, unsigned int k)
+	{
+		return k > n ? 0 : BINOMIALS[n][k];
+	}
+
+	/**
+	 * Lehmer rank of distinct values, which only needs their order: any values
+	 * below 22 work, such as the cubies of a state.
+	 * @param values - elements of the permutation
+	 * @param n - number of elements, up to MAX_RANKED_ELEMENTS
+	 */
+	inline uint32_t permutationRank(const uint8_t *values, unsigned int n)
+	{
+		uint32_t seen = 0, rank = 0;
+
+		for (unsigned int i = 0; i < n; i++)
+		{
+			rank += bitCount(seen >> values[i]) * FACTORIALS[i];
+			seen |= 1u << values[i];
+		}
+
+		return rank;
+	}
+
+	/**
+	 * Parity of the number of inversions of distinct values below 22.
+	 * @param values - elements of the permutation
+	 * @param n - number of elements
+	 */
+	inline uint16_t permutationParity(const uint8_t *values, unsigned int n)
+	{
+		uint32_t seen = 0, inversions = 0;
+
+		for (unsigned int i = 0; i < n; i++)
+		{
+			inversions += bitCount(seen >> values[i]);
+			seen |= 1u << values[i];
+		}
+
+		return inversions & 0b1;
+	}
+
+	/**
+	 * Permutation of the values first to first + n - 1 with the given Lehmer rank.
+	 * @param rank - rank given by permutationRank
+	 * @param n - number of elements, up to MAX_RANKED_ELEMENTS
+	 * @param first - smallest value
+	 * @param values - receives the n elements
+	 */
+	inline void permutationUnrank(uint32_t rank, unsigned int n, uint8_t first, uint8_t *values)
+	{
+		// Digits c_i of the factorial base, from the lowest
+		uint8_t larger[MAX_RANKED_ELEMENTS] = {};
+		for (unsigned int i = 1; i < n; i++)
+		{
+			larger[i] = rank % (i + 1);
+			rank /= i + 1;
+		}
+
+		// Values left in increasing order, 4 bits each
+		uint64_t remaining = 0;
+		for (unsigned int k = 0; k < n; k++)
+			remaining |= uint64_t(k) << (4 * k);
+
+		// From the last position, each element is the c_i-th largest of the i + 1 values left
+		for (unsigned int i = n; i-- > 0;)
+		{
+			unsigned int shift = 4 * (i - larger[i]);
+			values[i] = first + ((remaining >> shift) & 0xF);
+			remaining = (remaining & ((uint64_t(1) << shift) - 1)) | ((remaining >> (shift + 4)) << shift);
+		}
+	}
+
+	/**
+	 * Colexicographic rank of a set of positions.
+	 * @param set - bit p for position p, below MAX_RANKED_ELEMENTS
+	 */
+	inline uint16_t combinationRank(uint32_t set)
+	{
+		uint16_t rank = 0;
+
+		for (unsigned int k = 1; set != 0; k++, set &= set - 1)
+			rank += binomial(std::countr_zero(set), k);
+
+		return rank;
+	}
+
+	/**
+	 * Set of k positions with the given colexicographic rank.
+	 * @param rank - rank given by combinationRank
+	 * @param k - number of positions in the set
+	 * @return bit p for position p
+	 */
+	inline uint32_t combinationUnrank(uint32_t rank, unsigned int k)
+	{
+		uint32_t set = 0;
+
+		for (; k >= 1; k--)
+		{
+			unsigned int position = k - 1;
+			while (binomial(position + 1, k) <= rank)
+				position++;
+
+			set |= 1u << position;
+			rank -= binomial(position, k);
+		}
+
+		return set;
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <vector>
+
+#include "state.h"
+#include "move.h"
+#include "threadpool.h"
+#include "visitedtable.h"
+
+namespace rubik
+{
+	/**
+	 * Bounds of a search: a stop request, a wall-clock deadline and a budget of generated
+	 * states. The searches check them every few hundred expanded states.
+	 */
+	struct SearchLimits
+	{
+		std::stop_token stop;
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+		// Largest number of generated states, 0 for no limit
+		uint64_t maxNodes = 0;
+
+		/**
+		 * @param nodes - number of states generated so far
+		 * @return if the search must stop now
+		 */
+		bool reached(uint64_t nodes) const
+		{
+			return stop.stop_requested() || (maxNodes != 0 && nodes >= maxNodes) ||
+				   std::chrono::steady_clock::now() >= deadline;
+		}
+	};
+
+	/**
+	 * State waiting in the frontier of a layered search.
+	 */
+	struct FrontierNode
+	{
+		CubeState state;
+		TKMetrics id;
+		uint8_t directionMove;
+		// Face turned to reach the state, -1 for the roots of the search
+		int8_t lastFace;
+	};
+
+	/**
+	 * State waiting in the frontier of a search on the metrics alone (see MoveTables).
+	 */
+	struct CoordinateNode
+	{
+		TKMetrics id;
+		uint8_t directionMove;
+		int8_t lastFace;
+	};
+
+	/**
+	 * Memory of the breadth-first searches, kept between solves by the same thread.
+	 */
+	struct SearchScratch
+	{
+		VisitedTable visited;
+		// Single queue of the interleaved search
+		std::vector<CubeState> queue;
+		// Forward and backward frontiers of the layered searches
+		std::vector<FrontierNode> frontiers[2];
+		// Next layer, split per worker by the parallel search
+		std::vector<std::vector<FrontierNode>> children;
+		// Frontiers and next layer of the search on the metrics
+		std::vector<CoordinateNode> coordinateFrontiers[2];
+		std::vector<CoordinateNode> coordinateChildren;
+
+		// Used by the parallel search only
+		ConcurrentVisitedTable sharedVisited;
+		std::unique_ptr<ThreadPool> pool;
+
+		ThreadPool &getPool(unsigned int threads);
+		size_t bytes() const;
+	};
+
+	std::vector<Move> searchPhaseInterleaved(const CubeState &problem, unsigned int phase, bool canonical,
+											 SearchScratch &scratch, uint64_t &nodes,
+											 const SearchLimits &limits = SearchLimits());
+	std::vector<Move> searchPhase(const CubeState &problem, unsigned int phase, bool canonical, SearchScratch &scratch,
+								  uint64_t &nodes, const SearchLimits &limits = SearchLimits());
+	std::vector<Move> searchPhaseBlocks(const CubeState &problem, unsigned int phase, bool canonical,
+										SearchScratch &scratch, uint64_t &nodes,
+										const SearchLimits &limits = SearchLimits());
+	std::vector<Move> searchPhaseCoordinates(const CubeState &problem, unsigned int phase, bool canonical,
+											 SearchScratch &scratch, uint64_t &nodes,
+											 const SearchLimits &limits = SearchLimits());
+	std::vector<Move> searchPhaseGoalLayers(const CubeState &problem, unsigned int phase, bool canonical,
+											unsigned int goalDepth, SearchScratch &scratch, uint64_t &nodes,
+											const SearchLimits &limits = SearchLimits());
+	std::vector<Move> searchPhaseParallel(const CubeState &problem, unsigned int phase, bool canonical,
+										  unsigned int threads, SearchScratch &scratch, uint64_t &nodes,
+										  const SearchLimits &limits = SearchLimits());
+
+	/**
+	 * Build the algorithm of a phase once both searches met.
+	 * @param visited - table holding the predecessors of both searches
+	 * @param oldId - state that was expanded
+	 * @param newId - state reached from it, already seen by the other search
+	 * @param move - move from the expanded state to the reached one
+	 * @param oldDir - direction of the expanded state
+	 * @param problemId - metrics where the forward search started
+	 * @param goalId - metrics where the backward search started
+	 */
+	template <typename Table>
+	std::vector<Move> connectPaths(const Table &visited, TKMetrics oldId, TKMetrics newId, Move move, uint8_t oldDir,
+								   const TKMetrics &problemId, const TKMetrics &goalId)
+	{
+		// If the state comes from the solved state, invert the moves.
+		if ((oldDir & 0x40) == 0x40)
+		{
+			TKMetrics temp = oldId;
+			oldId = newId;
+			newId = temp;
+			move = move.inverse();
+		}
+
+		std::vector<Move> algorithm(1, move);
+		TKInformation information;
+
+		// Connect the positive path
+		while (oldId != problemId && visited.find(oldId, information))
+		{
+			algorithm.insert(algorithm.begin(), Move(information.directionMove & 0x3F));
+			oldId = information.pred;
+		}
+
+		// Connect the negative path
+		while (newId != goalId && visited.find(newId, information))
+		{
+			algorithm.push_back(Move(information.directionMove & 0x3F).inverse());
+			newId = information.pred;
+		}
+
+		return algorithm;
+	}
+}
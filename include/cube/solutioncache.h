@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "state.h"
+#include "move.h"
+
+namespace rubik
+{
+	/*
+	Solver whose solutions an entry holds. The engines find different solutions, and
+	some of their options change them too, so each one has entries of its own.
+	*/
+	struct CacheVariant
+	{
+		uint8_t engine = 0;
+		// Longest solution of the two-phase algorithm, milliseconds of the near-optimal one, 0 otherwise
+		uint32_t parameter = 0;
+		// The engine solves the parity of the centers (the hybrid and the near-optimal one)
+		bool centers = false;
+	};
+
+	/*
+	The key holds the cubies of the state, then the parity of every center for the
+	engines solving it and 0 for the others. The rest of their orientation is solved
+	afterwards by solveCenters. The key ends with the variant of the solver.
+	*/
+	const static unsigned int CACHE_STATE_SIZE = 2 * TOTAL_NUM_CUBIES + NUM_CENTERS;
+	const static unsigned int CACHE_KEY_SIZE = CACHE_STATE_SIZE + 1 + sizeof(uint32_t);
+
+	typedef std::array<uint8_t, CACHE_KEY_SIZE> CacheKey;
+
+	/**
+	 * Smallest of the 48 conjugates of a state, the same for every symmetric variant.
+	 * @param state - state to normalize
+	 * @param variant - solver of the entry
+	 * @param symmetry - set to the symmetry giving the representative from the state
+	 */
+	CacheKey normalizeState(const CubeState &state, const CacheVariant &variant, unsigned int &symmetry);
+	uint64_t normalizedStateHash(const CubeState &state, const CacheVariant &variant = CacheVariant());
+
+	struct SolutionCacheStats
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t insertions = 0;
+		uint64_t evictions = 0;
+		size_t entries = 0;
+		size_t bytes = 0;
+	};
+
+	/**
+	 * Solutions already found, shared by every state conjugate to them. An entry holds
+	 * the solution of the representative of the symmetry class, and is re-mapped
+	 * through the symmetry of the state asked for. Entries are evicted with the CLOCK
+	 * algorithm once the memory cap is reached. All the members are thread-safe.
+	 */
+	class SolutionCache
+	{
+		struct Entry
+		{
+			uint64_t hash;
+			CacheKey representative;
+			std::vector<uint8_t> moves;
+			bool referenced;
+			bool used;
+		};
+
+		mutable std::mutex _mutex;
+		std::vector<Entry> _entries;
+		std::vector<size_t> _freeEntries;
+		std::unordered_map<uint64_t, size_t> _index;
+		size_t _hand;
+		size_t _maxBytes;
+		SolutionCacheStats _stats;
+
+	public:
+		explicit SolutionCache(size_t maxBytes = 64 << 20);
+
+		bool find(const CubeState &state, const CacheVariant &variant, std::vector<Move> &solution);
+		void insert(const CubeState &state, const CacheVariant &variant, const std::vector<Move> &solution);
+		void clear();
+		SolutionCacheStats getStats() const;
+
+		bool save(const std::string &path) const;
+		bool load(const std::string &path);
+
+	private:
+		void store(uint64_t hash, const CacheKey &representative, std::vector<uint8_t> &&moves);
+		size_t evict();
+		static size_t entryBytes(const Entry &entry);
+	};
+}
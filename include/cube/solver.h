@@ -2,17 +2,146 @@
 
 // source: https://github.com/Cubically/thistlethwaite
 
+#include <cstdint>
+#include <functional>
+#include <iostream>
 #include <vector>
 #include <queue>
+#include <stop_token>
 
-#include "cube.h"
+#include "state.h"
 #include "move.h"
+#include "threadpool.h"
+#include "phasesearch.h"
 
 namespace rubik
 {
 	const unsigned static int THISTLETHWAITE_KOCIEMBA_PHASE_COUNT = 3;
 
-	std::queue<Move> thistlethwaiteKociemba(Cube* cube, CubeState problem);
+	class SolutionCache;
+
+	/**
+	 * Algorithms available to solve a cube.
+	 *	- THISTLETHWAITE_KOCIEMBA: table-free bidirectional search of three phases
+	 *	- KOCIEMBA: two-phase algorithm with pruning tables, ignores the centers
+	 *	- OPTIMAL: Korf's IDA* with pattern databases, shortest solutions, ignores the centers
+	 *	- THISTLETHWAITE: four phases solved by lookups in distance tables, no search, ignores the centers
+	 *	- NEAR_OPTIMAL: the hybrid phases after many first phases, the shortest total found before the time limit
+	 */
+	enum class SolverEngine
+	{
+		THISTLETHWAITE_KOCIEMBA,
+		KOCIEMBA,
+		OPTIMAL,
+		THISTLETHWAITE,
+		NEAR_OPTIMAL,
+	};
+
+	/*
+	Called with every complete solution shorter than the ones before it.
+	*/
+	typedef std::function<void(const std::vector<Move> &)> SolutionCallback;
+
+	// Time the near-optimal engine improves its solution when the options give no time limit
+	const static double NEAR_OPTIMAL_DEFAULT_SECONDS = 1.0;
+
+	struct SolverOptions
+	{
+		SolverEngine engine = SolverEngine::THISTLETHWAITE_KOCIEMBA;
+		// Longest solution accepted by the two-phase algorithm
+		unsigned int maxSolutionLength = 30;
+		// Threads expanding the frontiers of the hybrid search, 1 for the serial search
+		unsigned int searchThreads = 1;
+		// Threads of the optimal and near-optimal searches, 0 for every hardware thread (shared
+		// between the workers of solveMany)
+		unsigned int optimalThreads = 0;
+		// Expand the smaller frontier layer by layer instead of interleaving both directions
+		bool layeredSearch = true;
+		// Depth of the goal side of every phase precomputed once (see GoalLayers), 0 to search it at every solve
+		unsigned int goalDepth = 0;
+		// Run the serial layered search on the metrics alone, updated through MoveTables
+		bool incrementalMetrics = true;
+		// Turn and measure the layers of the serial layered search by blocks of states
+		bool blockExpansion = true;
+		// Never generate a face turned twice in a row nor both orders of opposite faces
+		bool canonicalPruning = true;
+		// Wall-clock budget of a solve in seconds, 0 for no limit (applied by solveState), the
+		// deadline of the near-optimal engine
+		double timeLimit = 0.0;
+		// Budget of generated states of a solve, 0 for no limit (applied by solveState)
+		uint64_t nodeLimit = 0;
+		// Looked up before solving and filled with the complete solutions, nullptr for none
+		SolutionCache *cache = nullptr;
+		// Receives the improvements of the near-optimal engine, on one of its threads
+		SolutionCallback onImprovement;
+	};
+
+	/**
+	 * How a solve ended. When it stopped early, the hybrid solution only reaches the
+	 * goal of the last phase completed and the two-phase solution is empty.
+	 */
+	enum class SolveStatus
+	{
+		SOLVED,
+		CANCELLED,
+		TIMED_OUT,
+		NODE_LIMIT,
+		// No solution within the longest length accepted
+		NOT_FOUND,
+	};
+
+	const char *solveStatusName(SolveStatus status);
+	SolveStatus stoppedStatus(const SearchLimits &limits, uint64_t nodes);
+
+	struct PhaseReport
+	{
+		double seconds = 0.0;
+		// Number of states generated by the search of the phase
+		uint64_t nodes = 0;
+		// Length of the algorithm of the phase before and after optimizeSolution
+		unsigned int movesBefore = 0;
+		unsigned int movesAfter = 0;
+	};
+
+	/**
+	 * What a solve found and what it cost. The solvers fill it instead of printing,
+	 * printSolveReport gives the console output of the application.
+	 */
+	struct SolveReport
+	{
+		SolveStatus status = SolveStatus::SOLVED;
+		std::vector<Move> solution;
+		// The solution comes from the cache, no search was run
+		bool cached = false;
+		double seconds = 0.0;
+		std::vector<PhaseReport> phases;
+		// Largest number of states held by the visited table
+		size_t peakVisited = 0;
+		// Bytes the SearchScratch of the hybrid phases grew by during the solve, 0 when a reused
+		// scratch was large enough. Not every allocation: the engines without a scratch report 0.
+		size_t scratchGrowthBytes = 0;
+		// Bytes held by the SearchScratch of the hybrid phases at the end of the solve
+		size_t scratchBytes = 0;
+	};
+
+	/*
+	Called with every move of the solution as soon as it is final, so that a
+	physical (or rendered) cube can start turning before the search ends.
+	*/
+	typedef std::function<void(const Move &)> MoveCallback;
+
+	SolveReport solveState(const CubeState &problem, const SolverOptions &options, const MoveCallback &onMove = nullptr,
+						   SearchScratch *scratch = nullptr, std::stop_token stop = std::stop_token());
+	std::vector<SolveReport> solveMany(const std::vector<CubeState> &problems, const SolverOptions &options,
+									   ThreadPool &pool);
+	std::vector<SolveReport> solveMany(const std::vector<CubeState> &problems, const SolverOptions &options,
+									   ThreadPool &pool, std::vector<SearchScratch> &scratches);
+	std::vector<SolveReport> solveMany(const std::vector<CubeState> &problems, const SolverOptions &options,
+									   unsigned int threads = 0);
+	void printSolveReport(std::ostream &s, const SolveReport &report);
+	std::queue<Move> thistlethwaiteKociemba(CubeState problem, const SolverOptions &options = SolverOptions(),
+											const MoveCallback &onMove = nullptr, SolveReport *report = nullptr,
+											SearchScratch *scratch = nullptr, const SearchLimits &limits = SearchLimits());
 	std::vector<Move> solveCenters(CubeState problem);
 	std::queue<Move> optimizeSolution(std::vector<Move> solution);
 }
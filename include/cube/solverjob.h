@@ -0,0 +1,32 @@
+#pragma once
+
+#include <future>
+#include <thread>
+
+#include "state.h"
+#include "solver.h"
+
+namespace rubik
+{
+	/**
+	 * Solve running on a thread of its own. The report is delivered through a future,
+	 * the solve can be cancelled at any time and is bounded by the time and node limits
+	 * of its options. A stopped solve still reports the phases it completed.
+	 * Destroying the job cancels it and waits for its thread.
+	 */
+	class SolverJob
+	{
+		std::shared_future<SolveReport> _report;
+		std::jthread _thread;
+
+	public:
+		SolverJob(const CubeState &problem, const SolverOptions &options, const MoveCallback &onMove = nullptr);
+
+		SolverJob(const SolverJob &) = delete;
+		SolverJob &operator=(const SolverJob &) = delete;
+
+		void cancel();
+		bool isDone() const;
+		std::shared_future<SolveReport> getReport() const;
+	};
+}
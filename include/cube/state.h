@@ -1,12 +1,14 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <vector>
 #include "move.h"
 
 namespace rubik
 {
 	/**********************************************************************
-	 * A cube 'state' is a vector<int> with 40 entries, the first 20
+	 * A cube 'state' is a fixed array of 46 bytes, the first 20
 	 * are a permutation of {0,...,19} and describe which cubie is at
 	 * a certain position (regarding the input ordering). The first
 	 * twelve are for edges, the last eight for corners.
@@ -23,6 +25,10 @@ namespace rubik
 	 * first twelve are edges, the last eight are corners. The values
 	 * are 0 or 1 for edges and 0, 1 or 2 for corners.
 	 *
+	 * The last 6 entries are the quarter turns (mod 4) of each center,
+	 * in the face order U, D, F, B, L, R. The array is padded to 48
+	 * bytes so that a state never needs the heap.
+	 *
 	 **********************************************************************/
 
 	/*
@@ -30,14 +36,14 @@ namespace rubik
 		- If there is a 1, the move is legal for the given phase
 		- If there is a 0, the move is illegal for the given phase
 	*/
-	const unsigned int THISTLETHWAITE_MOVES[] = {
+	constexpr unsigned int THISTLETHWAITE_MOVES[] = {
 		// 0b111111111111111111, // {U, D, F, B, L, R}
 		0b111111111111111111, // 0b111111010010111111, // {U, D, F2, B2, L, R}
 		0b010010010010111111, // {U, D, F2, B2, L2, R2}
 		0b010010010010111111, // {U, D, F2, B2, L2, R2}
 	};
 
-	const unsigned int KOCIEMBA_MOVES[] = {
+	constexpr unsigned int KOCIEMBA_MOVES[] = {
 		0b111111111111111111, // {U, D, F, B, L, R}
 		0b010010010010111111, // {U, D, F2, B2, L2, R2}
 	};
@@ -46,7 +52,7 @@ namespace rubik
 	What cubies while be modified by turning the given face.
 	4 edges [0-11] and 4 corners [0-7]
 	*/
-	const int AFFECTED_CUBIES[][8] = {
+	constexpr int AFFECTED_CUBIES[][8] = {
 		{0, 1, 2, 3, 0, 1, 2, 3},	// U
 		{4, 7, 6, 5, 4, 5, 6, 7},	// D
 		{0, 9, 4, 8, 0, 3, 5, 4},	// F
@@ -57,12 +63,165 @@ namespace rubik
 
 	const static unsigned int NUM_POSSIBLE_MOVES = 18;
 	const static unsigned int NUM_MOVES_PER_FACE = 3;
+	const static unsigned int ALL_MOVES = (1 << NUM_POSSIBLE_MOVES) - 1;
 	const static unsigned int NUM_EDGES = 12;
 	const static unsigned int NUM_MIDDLE_EDGES = 4;
 	const static unsigned int NUM_CORNERS = 8;
 	const static unsigned int NUM_CENTERS = 6;
 	const static unsigned int TOTAL_NUM_CUBIES = NUM_EDGES + NUM_CORNERS;
 
+	/**
+	 * Moves that may follow a turn of the given face in a canonical sequence. Turning
+	 * the same face again is never useful and opposite faces commute, so only one of
+	 * their two orders is kept.
+	 * @param lastFace - face of the previous move, negative if there is none
+	 */
+	constexpr unsigned int canonicalMoves(int lastFace)
+	{
+		unsigned int moves = 0;
+
+		for (int face = 0; face < 6; face++)
+		{
+			if (lastFace < 0 || (face != lastFace && !(face / 2 == lastFace / 2 && face < lastFace)))
+				moves |= 0b111 << (face * NUM_MOVES_PER_FACE);
+		}
+
+		return moves;
+	}
+
+	const static unsigned int STATE_SIZE = 2 * TOTAL_NUM_CUBIES + NUM_CENTERS;
+	const static unsigned int PACKED_STATE_SIZE = 48;
+
+	/*
+	Effect of a single move on the cubies, precomputed from AFFECTED_CUBIES.
+	The cubie moved to position i comes from position source[i] and its
+	orientation is increased by orientation[i] (already reduced modulo 2 or 3).
+	*/
+	struct MovePermutation
+	{
+		uint8_t source[TOTAL_NUM_CUBIES];
+		uint8_t orientation[TOTAL_NUM_CUBIES];
+	};
+
+	/**
+	 * Compose the quarter turns of every move into a single permutation with
+	 * its orientation changes, so that applying a move is a single pass.
+	 * Evaluated at compile time for MOVE_PERMUTATIONS.
+	 */
+	constexpr std::array<MovePermutation, NUM_POSSIBLE_MOVES> buildMovePermutations()
+	{
+		std::array<MovePermutation, NUM_POSSIBLE_MOVES> permutations{};
+
+		for (unsigned int m = 0; m < NUM_POSSIBLE_MOVES; m++)
+		{
+			int turns = m % NUM_MOVES_PER_FACE + 1;
+			int face = m / NUM_MOVES_PER_FACE;
+
+			MovePermutation &current = permutations[m];
+
+			for (unsigned int i = 0; i < TOTAL_NUM_CUBIES; i++)
+			{
+				current.source[i] = i;
+				current.orientation[i] = 0;
+			}
+
+			for (int t = 0; t < turns; t++)
+			{
+				MovePermutation old = current;
+
+				for (int i = 0; i < 8; i++)
+				{
+					int isCorner = (i >= 4);
+
+					// Swap (0 <- 1 <- 2 <- 3 <- 0) for both edges and corners
+					int target = AFFECTED_CUBIES[face][i] + isCorner * NUM_EDGES;
+
+					int newIndex = 0;
+					if (i % 4 == 3)
+						newIndex = i - 3;
+					else
+						newIndex = i + 1;
+					int newVal = AFFECTED_CUBIES[face][newIndex] + isCorner * NUM_EDGES;
+
+					int orientationDelta = 0;
+
+					// Edges only change orientation with one pair of move types.
+					// The two other pair can always replace the edges to their original state,
+					// but the last pair flips the edge piece.
+					if (i <= 3)
+						orientationDelta = (face == 2 || face == 3);
+
+					// Corners always change except with up or down moves.
+					else if (face <= 1)
+						orientationDelta = 0;
+
+					/*
+					 * Corner 0: +1 (F) +2 (R)
+					 * Corner 1: +1 (R) +2 (B)
+					 * Corner 2: +1 (B) +2 (L)
+					 * Corner 3: +1 (L) +2 (F)
+					 * Corner 4: +1 (R) +2 (F)
+					 * Corner 5: +1 (F) +2 (L)
+					 * Corner 6: +1 (L) +2 (B)
+					 * Corner 7: +1 (B) +2 (R)
+					 */
+					else
+						orientationDelta = 2 - (i % 2);
+
+					current.source[target] = old.source[newVal];
+					current.orientation[target] =
+						(old.orientation[newVal] + orientationDelta) % (2 + isCorner);
+				}
+			}
+		}
+
+		return permutations;
+	}
+
+	inline constexpr std::array<MovePermutation, NUM_POSSIBLE_MOVES> MOVE_PERMUTATIONS = buildMovePermutations();
+
+	const MovePermutation &getMovePermutation(const Move &move);
+
+	/*
+	Moves of a phase in increasing order, as a list instead of a mask, for every
+	face turned last (index lastFace + 1, 0 for none). The canonical lists drop
+	the moves that canonicalMoves forbids after that face.
+	*/
+	struct MoveList
+	{
+		uint8_t moves[NUM_POSSIBLE_MOVES];
+		uint8_t size;
+	};
+
+	constexpr std::array<MoveList, NUM_CENTERS + 1> buildMoveLists(unsigned int legalMoves, bool canonical)
+	{
+		std::array<MoveList, NUM_CENTERS + 1> lists{};
+
+		for (int lastFace = -1; lastFace < int(NUM_CENTERS); lastFace++)
+		{
+			MoveList &list = lists[lastFace + 1];
+			unsigned int moves = canonical ? legalMoves & canonicalMoves(lastFace) : legalMoves;
+
+			for (unsigned int m = 0; m < NUM_POSSIBLE_MOVES; m++)
+			{
+				if (moves & (1 << m))
+					list.moves[list.size++] = m;
+			}
+		}
+
+		return lists;
+	}
+
+	template <unsigned int Phase, bool Canonical>
+	inline constexpr std::array<MoveList, NUM_CENTERS + 1> PHASE_MOVE_LISTS =
+		buildMoveLists(THISTLETHWAITE_MOVES[Phase], Canonical);
+
+	/*
+	Canonical moves of the depth-first searches, among the given legal moves.
+	*/
+	template <unsigned int LegalMoves>
+	inline constexpr std::array<MoveList, NUM_CENTERS + 1> CANONICAL_MOVE_LISTS = buildMoveLists(LegalMoves, true);
+
 	struct TKMetrics
 	{
 		uint16_t m1;
@@ -79,18 +238,28 @@ namespace rubik
 
 	class CubeState
 	{
-		std::vector<uint8_t> _state;
+		alignas(16) std::array<uint8_t, PACKED_STATE_SIZE> _state;
 
 	public:
 		CubeState();
-		CubeState(std::vector<uint8_t> &s);
+		CubeState(const std::vector<uint8_t> &s);
+		explicit CubeState(const std::array<uint8_t, PACKED_STATE_SIZE> &s);
 		CubeState applyMove(const Move &move) const;
+		void applyMoveInPlace(const Move &move);
 		TKMetrics thistlethwaiteKociembaId(unsigned int phase) const;
+		template <unsigned int Phase>
+		TKMetrics phaseMetrics() const;
 		int size() const;
 
 		bool operator<(const CubeState &other_state) const;
+		bool operator==(const CubeState &other_state) const;
 		int operator[](const int i) const;
 
+		const uint8_t *data() const
+		{
+			return _state.data();
+		}
+
 		friend std::ostream &operator<<(std::ostream &s, const CubeState &state);
 	};
 }
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include "state.h"
+#include "move.h"
+
+namespace rubik
+{
+	const static unsigned int STATE_BLOCK_SIZE = 32;
+
+	/**
+	 * Block of states stored as a structure of arrays: row i holds the byte i of every
+	 * state. A move is then the same operation on whole rows, which the compiler turns
+	 * into vector instructions working on many states at once.
+	 */
+	struct StateBlock
+	{
+		alignas(32) uint8_t rows[PACKED_STATE_SIZE][STATE_BLOCK_SIZE];
+		// Number of states in use, from lane 0
+		unsigned int size = 0;
+
+		void set(unsigned int lane, const CubeState &state);
+		CubeState get(unsigned int lane) const;
+	};
+
+	/**
+	 * Metrics of the states of a block, one array per metric.
+	 */
+	struct MetricsBlock
+	{
+		alignas(32) uint16_t m1[STATE_BLOCK_SIZE];
+		alignas(32) uint16_t m2[STATE_BLOCK_SIZE];
+		alignas(32) uint16_t m3[STATE_BLOCK_SIZE];
+		alignas(32) uint16_t m4[STATE_BLOCK_SIZE];
+
+		TKMetrics get(unsigned int lane) const
+		{
+			return TKMetrics{m1[lane], m2[lane], m3[lane], m4[lane]};
+		}
+	};
+
+	void applyMoveBlock(const StateBlock &parents, const Move &move, StateBlock &children);
+	void metricsBlock(const StateBlock &block, unsigned int phase, MetricsBlock &metrics);
+	void expandBlock(const StateBlock &parents, const Move &move, unsigned int phase, StateBlock &children,
+					 MetricsBlock &metrics);
+}
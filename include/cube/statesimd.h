@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+#include "state.h"
+
+namespace rubik
+{
+	/**********************************************************************
+	 * Vector versions of the hot operations on the packed state. A move is
+	 * a byte shuffle of the 48 bytes (pshufb) followed by the addition of
+	 * the orientation changes and a subtraction of the modulo where it is
+	 * reached. The instruction set is picked once at startup from the CPU,
+	 * and every version gives exactly the same bytes as the scalar code.
+	 **********************************************************************/
+
+	enum class SimdLevel
+	{
+		SCALAR,
+		SSSE3,
+		AVX2,
+	};
+
+	typedef void (*ApplyMoveKernel)(uint8_t *state, uint8_t move);
+	typedef TKMetrics (*MetricsKernel)(const uint8_t *state);
+
+	/*
+	Kernels used by CubeState, nullptr for the scalar code.
+	*/
+	struct StateKernels
+	{
+		ApplyMoveKernel applyMove;
+		// Metrics of the first phase
+		MetricsKernel phase0Metrics;
+	};
+
+	extern StateKernels STATE_KERNELS;
+
+	SimdLevel detectSimdLevel();
+	SimdLevel getSimdLevel();
+	bool setSimdLevel(SimdLevel level);
+	const char *simdLevelName(SimdLevel level);
+}
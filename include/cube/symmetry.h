@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+#include "state.h"
+#include "move.h"
+#include "tablefile.h"
+
+namespace rubik
+{
+	/**********************************************************************
+	 * The 48 symmetries of the cube (24 rotations, each with or without
+	 * a mirror) as conjugations S X S^-1 of the cubies. A symmetry is
+	 * indexed by 16 * URF3 + 8 * F2 + 2 * U4 + LR2, where:
+	 *	- URF3: 120 degrees around the URF-DLB diagonal (0 to 2)
+	 *	- F2: 180 degrees around the F-B axis (0 or 1)
+	 *	- U4: 90 degrees around the U-D axis (0 to 3)
+	 *	- LR2: mirror swapping the L and R faces (0 or 1)
+	 * The first 16 symmetries keep the U-D axis in place, which is what
+	 * the coordinates of the middle slice need.
+	 **********************************************************************/
+
+	const static unsigned int NUM_SYMMETRIES = 48;
+	const static unsigned int NUM_UD_SYMMETRIES = 16;
+
+	/*
+	A symmetry moves the cubie of position i to position permutation[i] and
+	adds orientation[cubie] - orientation[i] to its orientation (negated first
+	for the corners of a mirror). Faces and moves are mapped the same way.
+	*/
+	struct Symmetry
+	{
+		uint8_t permutation[TOTAL_NUM_CUBIES];
+		uint8_t orientation[TOTAL_NUM_CUBIES];
+		uint8_t faces[NUM_CENTERS];
+		uint8_t moves[NUM_POSSIBLE_MOVES];
+		uint8_t inverse;
+		bool mirror;
+	};
+
+	const Symmetry &getSymmetry(unsigned int symmetry);
+	CubeState conjugate(const CubeState &state, unsigned int symmetry);
+	Move conjugate(const Move &move, unsigned int symmetry);
+
+	/*
+	Sizes of the raw coordinates reduced by the 16 U-D symmetries.
+	*/
+	const static uint32_t FLIP_SLICE_SIZE = 2048 * 495;
+	const static uint32_t FLIP_SLICE_CLASSES = 64430;
+	const static uint32_t CORNER_PERMUTATION_CLASSES = 2768;
+
+	/**
+	 * Symmetry classes of the (edge flip, slice combination) pair and of the corner
+	 * permutation under the 16 U-D symmetries. Every raw value is a conjugate of the
+	 * representative of its class: raw = conjugate(representative, symmetry).
+	 * A table indexed by a class instead of a raw value is about 16 times smaller.
+	 */
+	class SymmetryTables
+	{
+		MappedTable _files[5];
+
+		// Raw (slice * 2048 + flip) -> class | symmetry << 16
+		const uint32_t *_flipSliceClass;
+		const uint32_t *_flipSliceRepresentative;
+		// Raw corner permutation -> class | symmetry << 16
+		const uint32_t *_cornerClass;
+		const uint16_t *_cornerRepresentative;
+		// Corner twist conjugated by each U-D symmetry, [twist * 16 + symmetry]
+		const uint16_t *_twistConjugate;
+
+	public:
+		static const SymmetryTables &getInstance();
+
+		size_t bytes() const;
+
+		uint32_t flipSliceClass(uint16_t flip, uint16_t slice) const
+		{
+			return _flipSliceClass[slice * 2048 + flip] & 0xFFFF;
+		}
+
+		uint32_t cornerClass(uint16_t corners) const
+		{
+			return _cornerClass[corners] & 0xFFFF;
+		}
+
+	private:
+		SymmetryTables();
+	};
+
+	void printSymmetryFootprint(std::ostream &s);
+}
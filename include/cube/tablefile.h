@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace rubik
+{
+	/**********************************************************************
+	 * Solver tables are saved as binary files so they are only generated
+	 * once per machine. A file is a fixed header followed by the raw
+	 * entries:
+	 *
+	 *		magic "RBKT" | format version | table name (32 bytes) |
+	 *		entry count in bytes | 64-bit checksum of the entries
+	 *
+	 * The files are mapped read-only, so every solver process of a
+	 * machine shares the same physical pages. Bump the version whenever
+	 * the content of a table changes meaning.
+	 **********************************************************************/
+
+	const uint32_t TABLE_FILE_VERSION = 1;
+	const static unsigned int TABLE_NAME_LENGTH = 32;
+
+	struct TableFileHeader
+	{
+		char magic[4];
+		uint32_t version;
+		char name[TABLE_NAME_LENGTH];
+		uint64_t size;
+		uint64_t checksum;
+	};
+
+	struct TableFileOptions
+	{
+		// Directory of the table files, empty to use res/Tables or $RUBIK_TABLE_DIR
+		std::string directory;
+		// Fault all the pages in when mapping instead of on first access
+		bool populate = true;
+		// Ask for transparent huge pages on the mapping
+		bool hugePages = false;
+		// Write generated tables to the directory
+		bool persist = true;
+	};
+
+	/**
+	 * How a table was obtained and how long it took.
+	 */
+	struct TableLoadReport
+	{
+		std::string name;
+		size_t bytes;
+		bool fromFile;
+		double generationSeconds;
+		double loadSeconds;
+	};
+
+	void setTableFileOptions(const TableFileOptions &options);
+	const TableFileOptions &getTableFileOptions();
+	std::string getTableDirectory();
+	std::vector<TableLoadReport> getTableLoadReports();
+	void printTableLoadSummary(std::ostream &s);
+
+	uint64_t tableChecksum(const uint8_t *data, size_t size);
+
+	/**
+	 * Read-only table, either mapped from its file or kept in memory after being generated.
+	 */
+	class MappedTable
+	{
+		const uint8_t *_data;
+		size_t _size;
+		void *_mapping;
+		size_t _mappingSize;
+		std::vector<uint8_t> _memory;
+
+	public:
+		MappedTable();
+		MappedTable(MappedTable &&other) noexcept;
+		MappedTable &operator=(MappedTable &&other) noexcept;
+		MappedTable(const MappedTable &) = delete;
+		MappedTable &operator=(const MappedTable &) = delete;
+		~MappedTable();
+
+		bool map(const std::string &path, const std::string &name, size_t expectedSize);
+		void adopt(std::vector<uint8_t> &&memory);
+
+		const uint8_t *data() const { return _data; }
+		size_t size() const { return _size; }
+
+	private:
+		void release();
+	};
+
+	bool saveTable(const std::string &path, const std::string &name, const uint8_t *data, size_t size);
+
+	MappedTable loadOrBuildTable(const std::string &name, size_t expectedSize,
+								 const std::function<std::vector<uint8_t>()> &build);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+#include "coordinates.h"
+#include "tablefile.h"
+#include "solver.h"
+#include "state.h"
+#include "move.h"
+
+namespace rubik
+{
+	const unsigned static int THISTLETHWAITE_PHASE_COUNT = 4;
+
+	/*
+	Moves of the groups of Thistlethwaite's algorithm. Each phase brings the
+	cube from one group into the next one with the moves of the first.
+	*/
+	constexpr unsigned int THISTLETHWAITE_GROUP_MOVES[] = {
+		0b111111111111111111, // {U, D, F, B, L, R}
+		0b111111010010111111, // {U, D, F2, B2, L, R}
+		0b010010010010111111, // {U, D, F2, B2, L2, R2}
+		0b010010010010010010, // {U2, D2, F2, B2, L2, R2}
+	};
+
+	/*
+	Coordinates describing the position of a state in each phase.
+	*/
+	constexpr Coordinate THISTLETHWAITE_COORDINATES[][3] = {
+		{EDGE_FLIP, COORDINATE_COUNT, COORDINATE_COUNT},
+		{CORNER_TWIST, SLICE_COMBINATION, COORDINATE_COUNT},
+		{CORNER_PERMUTATION, EDGE_TETRAD, COORDINATE_COUNT},
+		{CORNER_PERMUTATION, EDGE_PERMUTATION, SLICE_PERMUTATION},
+	};
+
+	/*
+	Number of cosets of the next group in each group, the entries of the distance tables:
+	edge flips, corner twists and middle slice combinations, corner permutations modulo
+	the half turns (420) and combinations of the UR, UL, DR and DL edges out of the middle
+	slice (70), then corner permutations (96), top and bottom edge permutations (576) and
+	middle slice permutations of matching parity (12) reachable with half turns.
+	*/
+	const uint32_t THISTLETHWAITE_PHASE_SIZES[] = {2048, 2187 * 495, 420 * 70, 96 * 576 * 12};
+
+	// Value of a distance table entry that was never reached
+	const static uint8_t UNREACHED_DISTANCE = 0b11;
+
+	/**
+	 * Distance of every coset to the next group, 2 bits per entry. Each entry is the
+	 * distance modulo 3: a move changes the distance by at most one, so the moves that
+	 * bring a state closer to the goal are the ones reaching the entry one below it.
+	 */
+	class ThistlethwaiteTables
+	{
+		MappedTable _files[THISTLETHWAITE_PHASE_COUNT];
+
+		// Coset of the half turns of every corner permutation, and the smallest permutation of each coset
+		std::vector<uint16_t> _cornerCoset;
+		std::vector<uint16_t> _cosetCorners;
+		// Index of the edge combinations out of the middle slice, and the combination of each index
+		std::vector<uint16_t> _tetradIndex;
+		std::vector<uint16_t> _tetradValue;
+		// Index of the corner and edge permutations reachable with half turns, and the permutation of each index
+		std::vector<uint16_t> _cornerIndex;
+		std::vector<uint16_t> _cornerValue;
+		std::vector<uint16_t> _edgeIndex;
+		std::vector<uint16_t> _edgeValue;
+		// Index of the middle slice permutations among the ones of the same parity, and back
+		uint8_t _sliceIndex[24];
+		uint8_t _sliceValue[2][12];
+
+		const uint8_t *_distances[THISTLETHWAITE_PHASE_COUNT];
+
+	public:
+		static const ThistlethwaiteTables &getInstance();
+
+		uint32_t index(unsigned int phase, const uint16_t *values) const;
+		void values(unsigned int phase, uint32_t index, uint16_t *values) const;
+
+		/**
+		 * @param phase - table to read
+		 * @param index - entry to read, given by index
+		 */
+		uint8_t distance(unsigned int phase, uint32_t index) const
+		{
+			return (_distances[phase][index >> 2] >> ((index & 3) * 2)) & 0b11;
+		}
+
+	private:
+		ThistlethwaiteTables();
+		std::vector<uint8_t> buildDistanceTable(unsigned int phase) const;
+	};
+
+	std::queue<Move> thistlethwaite(CubeState problem, SolveReport *report = nullptr);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rubik
+{
+	/**
+	 * Fixed set of workers running batches of indexed jobs. Each worker owns a deque of
+	 * jobs, takes work from its back and, once empty, steals from the front of the others.
+	 */
+	class ThreadPool
+	{
+	public:
+		typedef std::function<void(size_t job, unsigned int worker)> Job;
+
+	private:
+		struct Worker
+		{
+			std::mutex mutex;
+			std::deque<size_t> jobs;
+		};
+
+		std::vector<std::thread> _threads;
+		std::vector<std::unique_ptr<Worker>> _workers;
+
+		std::mutex _mutex;
+		std::condition_variable _wake;
+		std::condition_variable _done;
+		const Job *_job;
+		uint64_t _batch;
+		std::atomic<size_t> _remaining;
+		unsigned int _active;
+		bool _stopping;
+
+	public:
+		explicit ThreadPool(unsigned int threads = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		static unsigned int workerCount(unsigned int threads);
+
+		unsigned int size() const;
+		void run(size_t jobCount, const Job &job);
+
+	private:
+		bool takeJob(unsigned int worker, size_t &job);
+		void work(unsigned int worker);
+	};
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "state.h"
+
+namespace rubik
+{
+	struct TKInformation
+	{
+		// State that was used to reach the current state
+		TKMetrics pred;
+		// Direction from which the state was reached (10 for unsolved, 01 for solved)
+		// and Move used to reach it
+		uint8_t directionMove;
+	};
+
+	struct VisitedTableStats
+	{
+		size_t size;
+		size_t peakSize;
+		size_t capacity;
+		uint64_t lookups;
+		uint64_t probes;
+		uint32_t maxProbeLength;
+
+		double averageProbeLength() const
+		{
+			return lookups == 0 ? 0.0 : double(probes) / double(lookups);
+		}
+	};
+
+	/**
+	 * Pack the four metrics into a single key.
+	 */
+	inline uint64_t packMetrics(const TKMetrics &metrics)
+	{
+		return uint64_t(metrics.m1) | (uint64_t(metrics.m2) << 16) |
+			   (uint64_t(metrics.m3) << 32) | (uint64_t(metrics.m4) << 48);
+	}
+
+	/**
+	 * Mix the bits of a packed key so that neighbouring metrics spread over the table.
+	 */
+	inline uint64_t hashMetricsKey(uint64_t key)
+	{
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ULL;
+		key ^= key >> 33;
+		return key;
+	}
+
+	/**
+	 * Open-addressing (linear probing) table of the states met by the search.
+	 * Clearing only bumps a generation counter so the memory is kept between phases.
+	 */
+	class VisitedTable
+	{
+		struct Entry
+		{
+			uint64_t key;
+			TKInformation information;
+			uint16_t generation;
+		};
+
+		std::vector<Entry> _entries;
+		size_t _mask;
+		size_t _size;
+		uint16_t _generation;
+		VisitedTableStats _stats;
+
+	public:
+		VisitedTable(size_t initialCapacity = 1 << 16);
+
+		/**
+		 * Find the information of a state, inserting an empty one if it was never seen.
+		 * The reference is invalidated by the next insertion.
+		 * @param metrics - metrics of the state
+		 */
+		TKInformation &operator[](const TKMetrics &metrics)
+		{
+			uint64_t key = packMetrics(metrics);
+
+			if (2 * (_size + 1) > _entries.size())
+				grow();
+
+			size_t index = hashMetricsKey(key) & _mask;
+			uint32_t probeLength = 1;
+
+			while (_entries[index].generation == _generation && _entries[index].key != key)
+			{
+				index = (index + 1) & _mask;
+				probeLength++;
+			}
+
+			recordProbe(probeLength);
+
+			Entry &entry = _entries[index];
+			if (entry.generation != _generation)
+			{
+				entry.key = key;
+				entry.information = TKInformation{TKMetrics{0, 0, 0, 0}, 0};
+				entry.generation = _generation;
+				_size++;
+			}
+
+			return entry.information;
+		}
+
+		bool find(const TKMetrics &metrics, TKInformation &information) const;
+		void clear();
+		void reset();
+		size_t size() const;
+		size_t bytes() const;
+		VisitedTableStats getStats() const;
+
+	private:
+		void recordProbe(uint32_t probeLength)
+		{
+			_stats.lookups++;
+			_stats.probes += probeLength;
+			if (probeLength > _stats.maxProbeLength)
+				_stats.maxProbeLength = probeLength;
+		}
+
+		void grow();
+	};
+
+	/**
+	 * Visited table shared by the threads expanding a frontier. The metrics and the
+	 * direction/move byte are published together by a single compare-and-swap, so a
+	 * thread can always tell which side of the search reached a state first.
+	 * Growing is not thread-safe: reserve enough slots before each layer.
+	 */
+	class ConcurrentVisitedTable
+	{
+		struct Entry
+		{
+			// Packed metrics in the 56 low bits, direction and move in the 8 high bits
+			std::atomic<uint64_t> word;
+			uint64_t pred;
+		};
+
+		const static uint64_t KEY_MASK = (uint64_t(1) << 56) - 1;
+
+		std::unique_ptr<Entry[]> _entries;
+		size_t _capacity;
+		std::atomic<size_t> _size;
+		size_t _peakSize;
+
+	public:
+		ConcurrentVisitedTable();
+
+		void clear();
+		void reset();
+		void reserve(size_t expectedSize);
+
+		/**
+		 * Insert a state if it was never seen.
+		 * @param metrics - metrics of the state
+		 * @param directionMove - direction of the search and move that reached the state
+		 * @param pred - metrics of the state it was reached from
+		 * @return 0 if the state was inserted, the direction/move byte of the first visit otherwise
+		 */
+		uint8_t insert(const TKMetrics &metrics, uint8_t directionMove, const TKMetrics &pred)
+		{
+			const uint64_t key = packMetrics(metrics);
+			const uint64_t word = key | (uint64_t(directionMove) << 56);
+			const size_t mask = _capacity - 1;
+
+			size_t index = hashMetricsKey(key) & mask;
+
+			while (true)
+			{
+				Entry &entry = _entries[index];
+				uint64_t current = entry.word.load(std::memory_order_acquire);
+
+				if (current == 0)
+				{
+					if (entry.word.compare_exchange_strong(current, word, std::memory_order_acq_rel))
+					{
+						entry.pred = packMetrics(pred);
+						_size.fetch_add(1, std::memory_order_relaxed);
+						return 0;
+					}
+				}
+
+				if ((current & KEY_MASK) == key)
+					return uint8_t(current >> 56);
+
+				index = (index + 1) & mask;
+			}
+		}
+
+		bool find(const TKMetrics &metrics, TKInformation &information) const;
+		size_t size() const;
+		size_t peakSize() const;
+		size_t bytes() const;
+	};
+}
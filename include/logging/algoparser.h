@@ -1,5 +1,7 @@
 #pragma once
 
+#include <istream>
+#include <string>
 #include <vector>
 #include <queue>
 
@@ -8,5 +10,7 @@
 namespace parsing
 {
     std::vector<rubik::Move> parseAlgorithm(std::string filePath);
+    std::vector<rubik::Move> parseAlgorithm(std::istream &stream, const std::string &source, bool *valid = nullptr);
+    std::vector<rubik::Move> parseAlgorithmString(const std::string &algorithm, bool *valid = nullptr);
     void saveProblem(std::string filePath, std::queue<rubik::Move> solution);
 }
\ No newline at end of file
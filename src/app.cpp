@@ -118,14 +118,19 @@ int Application::launch()
             _cube.turnFace(input);
         }
 
-        /* Solve the rubik's cube. Do this asynchronously since it can be long */
+        /* Solve the rubik's cube. The solver runs as a job since it can be long */
         if (glfwGetKey(_window->getWindow(), GLFW_KEY_ENTER) && !_cube.isSolving())
         {
-            std::thread solvingThread(&rubik::Cube::solve, &_cube);
-            solvingThread.detach();
+            _cube.solve();
             _frame = 0;
         }
 
+        /* Cancel the solve, the phases already solved are still turned */
+        if (glfwGetKey(_window->getWindow(), GLFW_KEY_ESCAPE) && _cube.isSolving())
+        {
+            _cube.cancelSolve();
+        }
+
         /* Scramble the rubik's cube */
         if (glfwGetKey(_window->getWindow(), GLFW_KEY_BACKSPACE) && _frame % 5 == 0 && !_cube.isSolving())
         {
@@ -346,6 +351,58 @@ void Application::renderImGui()
             }
             ImGui::EndMenu();
         }
+        if (ImGui::BeginMenu("Solver"))
+        {
+            rubik::SolverEngine engine = _cube.getSolverEngine();
+            bool hybrid = engine == rubik::SolverEngine::THISTLETHWAITE_KOCIEMBA;
+
+            if (ImGui::MenuItem("Thistlethwaite-Kociemba", nullptr, hybrid))
+            {
+                _cube.setSolverEngine(rubik::SolverEngine::THISTLETHWAITE_KOCIEMBA);
+            }
+            if (ImGui::MenuItem("Kociemba (two-phase)", nullptr, engine == rubik::SolverEngine::KOCIEMBA))
+            {
+                _cube.setSolverEngine(rubik::SolverEngine::KOCIEMBA);
+            }
+            if (ImGui::MenuItem("Optimal (Korf)", nullptr, engine == rubik::SolverEngine::OPTIMAL))
+            {
+                _cube.setSolverEngine(rubik::SolverEngine::OPTIMAL);
+            }
+            if (ImGui::MenuItem("Thistlethwaite (lookup)", nullptr, engine == rubik::SolverEngine::THISTLETHWAITE))
+            {
+                _cube.setSolverEngine(rubik::SolverEngine::THISTLETHWAITE);
+            }
+            if (ImGui::MenuItem("Near-optimal (anytime)", nullptr, engine == rubik::SolverEngine::NEAR_OPTIMAL))
+            {
+                _cube.setSolverEngine(rubik::SolverEngine::NEAR_OPTIMAL);
+            }
+            ImGui::Separator();
+
+            bool parallel = _cube.getSearchThreads() > 1;
+            if (ImGui::MenuItem("Parallel search", nullptr, parallel, hybrid))
+            {
+                _cube.setSearchThreads(parallel ? 1 : std::thread::hardware_concurrency());
+            }
+            if (ImGui::BeginMenu("Time limit"))
+            {
+                const double limits[] = {0.0, 1.0, 5.0, 30.0};
+                const char *names[] = {"None", "1 second", "5 seconds", "30 seconds"};
+
+                for (int i = 0; i < 4; i++)
+                {
+                    if (ImGui::MenuItem(names[i], nullptr, _cube.getTimeLimit() == limits[i]))
+                        _cube.setTimeLimit(limits[i]);
+                }
+                ImGui::EndMenu();
+            }
+            ImGui::Separator();
+
+            if (ImGui::MenuItem("Cancel solve", "Esc", false, _cube.isSolving()))
+            {
+                _cube.cancelSolve();
+            }
+            ImGui::EndMenu();
+        }
         if (ImGui::BeginMenu("Algorithms"))
         {
             if (ImGui::MenuItem("Import Algorithms"))
@@ -399,13 +456,18 @@ void Application::renderImGui()
         ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.0f, 0.0f, 0.0f, 0.2f));
         ImGui::Begin("solving window", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMouseInputs);
 
-        float xPos = (ImGui::GetWindowSize().x - ImGui::CalcTextSize("Solving...").x) * 0.5f;
-        float yPos = (ImGui::GetWindowSize().y - ImGui::CalcTextSize("Solving...").y) * 0.5f;
+        // The near-optimal solver shows the length it reached so far
+        std::string text = "Solving...";
+        if (_cube.getBestLength() > 0)
+            text += " best " + std::to_string(_cube.getBestLength()) + " moves";
+
+        float xPos = (ImGui::GetWindowSize().x - ImGui::CalcTextSize(text.c_str()).x) * 0.5f;
+        float yPos = (ImGui::GetWindowSize().y - ImGui::CalcTextSize(text.c_str()).y) * 0.5f;
         ImGui::SetCursorPosX(xPos);
         ImGui::SetCursorPosY(yPos);
 
         ImGui::SetWindowFontScale(2.0f);
-        ImGui::Text("Solving...", 20);
+        ImGui::Text("%s", text.c_str());
 
         ImGui::End();
         ImGui::PopStyleColor();
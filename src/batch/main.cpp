@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cube/solutioncache.h"
+#include "cube/solver.h"
+#include "cube/symmetry.h"
+#include "cube/tablefile.h"
+#include "logging/algoparser.h"
+#include "logging/utils.h"
+
+/**
+ * Headless solver. Reads one scramble per line (same notation as the ALGO files)
+ * and writes one JSON object per line with the solution and the report of the solve.
+ */
+
+struct BatchResult
+{
+    std::string solution;
+    rubik::SolveReport report;
+};
+
+static void printUsage()
+{
+    std::cerr << "Usage: rubik_batch [options] [file]\n"
+              << "Solves the scrambles of the file (or of the standard input), one per line.\n"
+              << "  --engine <hybrid|kociemba|optimal|thistlethwaite|near-optimal>\n"
+              << "                              solver to use (default: hybrid)\n"
+              << "  --max-length <n>            longest solution of the two-phase solver (default: 30)\n"
+              << "  --threads <n>               number of solving threads, 0 for all cores (default: 1)\n"
+              << "  --search-threads <n>        threads expanding each search of the hybrid solver (default: 1),\n"
+              << "                              or sharing each optimal and near-optimal search (default: 0 for all cores)\n"
+              << "  --goal-depth <n>            moves of the goal side of the hybrid phases precomputed once,\n"
+              << "                              0 to search it at every solve (default: 0)\n"
+              << "  --time-limit <seconds>      stop each solve after this time, 0 for no limit (default: 0)\n"
+              << "  --node-limit <n>            stop each solve after this many states, 0 for no limit (default: 0)\n"
+              << "  --cache <file>              reuse the solutions of the file and save them back at the end\n"
+              << "  --cache-size <MB>           memory cap of the solution cache (default: 64)\n"
+              << "  --symmetry-report           print the size of the tables reduced by symmetry and exit\n"
+              << "  /?, --help                  show this message" << std::endl;
+}
+
+/**
+ * Read the value of a numeric option. Negative values of unsigned options are rejected.
+ * @param text - value given on the command line
+ * @param value - set to the number if the whole text is one
+ * @return if the text is a valid number
+ */
+template <typename T>
+static bool parseNumber(const char *text, T &value)
+{
+    const char *end = text + std::strlen(text);
+    auto [last, error] = std::from_chars(text, end, value);
+    return error == std::errc() && last == end;
+}
+
+/**
+ * Report an option value that is not a number of the expected kind.
+ * @return exit code of the program
+ */
+static int invalidValue(const std::string &option, const std::string &value)
+{
+    std::cerr << "ERROR: Invalid value " << value << " for " << option << "." << std::endl;
+    printUsage();
+    return 1;
+}
+
+static std::string escapeJson(const std::string &text)
+{
+    std::string escaped;
+
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            escaped += ' ';
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+static BatchResult makeResult(const rubik::SolveReport &report)
+{
+    BatchResult result;
+    result.report = report;
+
+    std::ostringstream moves;
+    for (size_t m = 0; m < report.solution.size(); m++)
+        moves << (m == 0 ? "" : " ") << report.solution[m];
+    result.solution = moves.str();
+
+    return result;
+}
+
+static void writeResult(std::ostream &s, size_t index, const std::string &scramble,
+                        const BatchResult &result, const char *engine, long duplicateOf)
+{
+    s << "{\"index\":" << index
+      << ",\"scramble\":\"" << escapeJson(scramble) << "\""
+      << ",\"engine\":\"" << engine << "\""
+      << ",\"status\":\"" << rubik::solveStatusName(result.report.status) << "\""
+      << ",\"solution\":\"" << result.solution << "\""
+      << ",\"moves\":" << result.report.solution.size()
+      << ",\"seconds\":" << result.report.seconds
+      << ",\"cached\":" << (result.report.cached ? "true" : "false")
+      << ",\"peak_visited\":" << result.report.peakVisited
+      << ",\"scratch_growth_bytes\":" << result.report.scratchGrowthBytes
+      << ",\"phases\":[";
+
+    for (size_t p = 0; p < result.report.phases.size(); p++)
+    {
+        const rubik::PhaseReport &phase = result.report.phases[p];
+        s << (p == 0 ? "" : ",") << "{\"seconds\":" << phase.seconds << ",\"nodes\":" << phase.nodes
+          << ",\"moves_before\":" << phase.movesBefore << ",\"moves_after\":" << phase.movesAfter << "}";
+    }
+
+    s << "],\"duplicate_of\":";
+    if (duplicateOf < 0)
+        s << "null";
+    else
+        s << duplicateOf;
+
+    s << "}" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    rubik::SolverOptions options;
+    std::string inputPath = "-";
+    unsigned int threads = 1;
+    std::string cachePath;
+    size_t cacheMegabytes = 64;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if (argument == "/?" || argument == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (argument == "--symmetry-report")
+        {
+            rubik::printSymmetryFootprint(std::cout);
+            return 0;
+        }
+        else if (argument == "--engine" && i + 1 < argc)
+        {
+            std::string engine = argv[++i];
+            if (engine == "hybrid")
+                options.engine = rubik::SolverEngine::THISTLETHWAITE_KOCIEMBA;
+            else if (engine == "kociemba")
+                options.engine = rubik::SolverEngine::KOCIEMBA;
+            else if (engine == "optimal")
+                options.engine = rubik::SolverEngine::OPTIMAL;
+            else if (engine == "thistlethwaite")
+                options.engine = rubik::SolverEngine::THISTLETHWAITE;
+            else if (engine == "near-optimal")
+                options.engine = rubik::SolverEngine::NEAR_OPTIMAL;
+            else
+            {
+                std::cerr << "ERROR: Unknown engine " << engine << "." << std::endl;
+                return 1;
+            }
+        }
+        else if (argument == "--threads" && i + 1 < argc)
+        {
+            if (!parseNumber(argv[++i], threads))
+                return invalidValue(argument, argv[i]);
+        }
+        else if (argument == "--search-threads" && i + 1 < argc)
+        {
+            unsigned int searchThreads = 0;
+            if (!parseNumber(argv[++i], searchThreads))
+                return invalidValue(argument, argv[i]);
+
+            options.searchThreads = std::max(1u, searchThreads);
+            options.optimalThreads = searchThreads;
+        }
+        else if (argument == "--goal-depth" && i + 1 < argc)
+        {
+            if (!parseNumber(argv[++i], options.goalDepth))
+                return invalidValue(argument, argv[i]);
+        }
+        else if (argument == "--max-length" && i + 1 < argc)
+        {
+            if (!parseNumber(argv[++i], options.maxSolutionLength))
+                return invalidValue(argument, argv[i]);
+        }
+        else if (argument == "--cache" && i + 1 < argc)
+        {
+            cachePath = argv[++i];
+        }
+        else if (argument == "--cache-size" && i + 1 < argc)
+        {
+            if (!parseNumber(argv[++i], cacheMegabytes))
+                return invalidValue(argument, argv[i]);
+        }
+        else if (argument == "--time-limit" && i + 1 < argc)
+        {
+            if (!parseNumber(argv[++i], options.timeLimit) || !(options.timeLimit >= 0.0))
+                return invalidValue(argument, argv[i]);
+        }
+        else if (argument == "--node-limit" && i + 1 < argc)
+        {
+            if (!parseNumber(argv[++i], options.nodeLimit))
+                return invalidValue(argument, argv[i]);
+        }
+        else if (argument.size() > 1 && argument[0] == '-')
+        {
+            std::cerr << "ERROR: Unknown option " << argument << "." << std::endl;
+            printUsage();
+            return 1;
+        }
+        else
+        {
+            inputPath = argument;
+        }
+    }
+
+    std::ifstream file;
+    if (inputPath != "-")
+    {
+        file.open(inputPath);
+        if (!file.is_open())
+        {
+            std::cerr << "ERROR: The scramble file (" << inputPath << ") cannot be found." << std::endl;
+            return 1;
+        }
+    }
+    std::istream &input = inputPath == "-" ? std::cin : file;
+
+    const char *engineName = options.engine == rubik::SolverEngine::KOCIEMBA         ? "kociemba"
+                             : options.engine == rubik::SolverEngine::OPTIMAL        ? "optimal"
+                             : options.engine == rubik::SolverEngine::THISTLETHWAITE ? "thistlethwaite"
+                             : options.engine == rubik::SolverEngine::NEAR_OPTIMAL   ? "near-optimal"
+                                                                                     : "hybrid";
+
+    rubik::SolutionCache cache(cacheMegabytes << 20);
+    if (!cachePath.empty())
+    {
+        cache.load(cachePath);
+        options.cache = &cache;
+    }
+
+    rubik::ThreadPool pool(threads);
+    // Search memory of every worker, reused from one block to the next
+    std::vector<rubik::SearchScratch> scratches(pool.size());
+
+    // Lines are solved by blocks so that the results keep streaming with many threads.
+    const size_t blockSize = pool.size() == 1 ? 1 : 16 * pool.size();
+
+    // Identical states are only solved once per batch
+    std::map<rubik::CubeState, size_t> solvedStates;
+    std::vector<BatchResult> results;
+    std::vector<size_t> resultIndices;
+
+    std::string line;
+    size_t index = 0;
+    bool ended = false;
+
+    while (!ended)
+    {
+        std::vector<std::string> lines;
+        std::vector<long> lineResults;
+        std::vector<rubik::CubeState> problems;
+
+        while (lines.size() < blockSize && !(ended = !std::getline(input, line)))
+        {
+            line = trim(line);
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            bool valid = true;
+            std::vector<rubik::Move> scramble = parsing::parseAlgorithmString(line, &valid);
+
+            lines.push_back(line);
+
+            if (!valid)
+            {
+                lineResults.push_back(-1);
+                continue;
+            }
+
+            rubik::CubeState state;
+            for (const rubik::Move &move : scramble)
+                state.applyMoveInPlace(move);
+
+            auto known = solvedStates.find(state);
+            if (known != solvedStates.end())
+            {
+                lineResults.push_back(known->second);
+            }
+            else
+            {
+                solvedStates[state] = results.size() + problems.size();
+                lineResults.push_back(results.size() + problems.size());
+                problems.push_back(state);
+                resultIndices.push_back(index + lines.size() - 1);
+            }
+        }
+
+        std::vector<rubik::SolveReport> reports = rubik::solveMany(problems, options, pool, scratches);
+
+        for (const rubik::SolveReport &report : reports)
+            results.push_back(makeResult(report));
+
+        for (size_t l = 0; l < lines.size(); l++, index++)
+        {
+            if (lineResults[l] < 0)
+            {
+                std::cout << "{\"index\":" << index << ",\"scramble\":\"" << escapeJson(lines[l])
+                          << "\",\"error\":\"invalid scramble\"}" << std::endl;
+                continue;
+            }
+
+            size_t first = resultIndices[lineResults[l]];
+            writeResult(std::cout, index, lines[l], results[lineResults[l]], engineName,
+                        first == index ? -1 : long(first));
+        }
+    }
+
+    rubik::printTableLoadSummary(std::cerr);
+
+    if (!cachePath.empty())
+    {
+        rubik::SolutionCacheStats stats = cache.getStats();
+        std::cerr << "Cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.entries
+                  << " entries (" << stats.bytes << " bytes), " << stats.evictions << " evictions" << std::endl;
+
+        if (!cache.save(cachePath))
+            std::cerr << "ERROR: The solution cache (" << cachePath << ") cannot be saved." << std::endl;
+    }
+
+    return 0;
+}
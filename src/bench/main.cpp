@@ -0,0 +1,735 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cube/coordinates.h"
+#include "cube/permutation.h"
+#include "cube/solver.h"
+#include "cube/stateblock.h"
+#include "cube/statesimd.h"
+#include "cube/tablefile.h"
+
+/**
+ * Benchmarks of the hot paths of the solver on a fixed-seed scramble corpus.
+ * Every result is a single number where lower is better (nanoseconds, seconds,
+ * nodes or moves), written as JSON. With a baseline, the results are compared
+ * and the regressions beyond the threshold make the program fail.
+ */
+
+struct BenchResult
+{
+    std::string name;
+    double value;
+    std::string unit;
+};
+
+struct BenchOptions
+{
+    unsigned int seed = 42;
+    unsigned int scrambles = 20;
+    unsigned int scrambleLength = 25;
+    unsigned int corpus = 10000;
+    unsigned int optimalLength = 12;
+    unsigned int searchThreads = 0;
+    double minSeconds = 0.2;
+    std::vector<std::string> groups;
+};
+
+static void printUsage()
+{
+    std::cerr << "Usage: rubik_bench [options]\n"
+              << "Times the solver on a fixed-seed scramble corpus and writes the results as JSON.\n"
+              << "  --seed <n>             seed of the scrambles (default: 42)\n"
+              << "  --scrambles <n>        number of scrambles of the solve benchmarks (default: 20)\n"
+              << "  --length <n>           number of moves of every scramble (default: 25)\n"
+              << "  --corpus <n>           number of scrambles of the thread scaling benchmark (default: 10000)\n"
+              << "  --optimal-length <n>   number of moves of the scrambles of the optimal solver (default: 12)\n"
+              << "  --search-threads <n>   threads of the parallel hybrid search, 0 for all cores (default: 0)\n"
+              << "  --only <groups>        comma separated groups among state, coordinates, optimize,\n"
+              << "                         hybrid, kociemba, optimal, thistlethwaite, near_optimal and scaling\n"
+              << "                         (default: all)\n"
+              << "  --out <file>           write the JSON to a file instead of the standard output\n"
+              << "  --baseline <file>      compare the results with a previous JSON output\n"
+              << "  --threshold <percent>  slowdown reported as a regression (default: 10)\n"
+              << "  /?, --help             show this message" << std::endl;
+}
+
+/**
+ * Random scrambles that never turn the same face twice in a row.
+ */
+static std::vector<std::vector<rubik::Move>> makeScrambles(unsigned int count, unsigned int length, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    std::vector<std::vector<rubik::Move>> scrambles(count);
+
+    for (std::vector<rubik::Move> &scramble : scrambles)
+    {
+        int lastFace = -1;
+        while (scramble.size() < length)
+        {
+            rubik::Move move(int(random() % rubik::NUM_POSSIBLE_MOVES));
+            if (move.getFace() == lastFace)
+                continue;
+
+            scramble.push_back(move);
+            lastFace = move.getFace();
+        }
+    }
+
+    return scrambles;
+}
+
+static std::vector<rubik::CubeState> toStates(const std::vector<std::vector<rubik::Move>> &scrambles)
+{
+    std::vector<rubik::CubeState> states;
+
+    for (const std::vector<rubik::Move> &scramble : scrambles)
+    {
+        rubik::CubeState state;
+        for (const rubik::Move &move : scramble)
+            state.applyMoveInPlace(move);
+        states.push_back(state);
+    }
+
+    return states;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    return duration.count();
+}
+
+/**
+ * Repeat a batch of operations until the minimum time is spent.
+ * @param batch - runs operations and returns how many it ran
+ * @return nanoseconds per operation
+ */
+static double timePerOperation(double minSeconds, const std::function<size_t()> &batch)
+{
+    size_t operations = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    do
+    {
+        operations += batch();
+    } while (secondsSince(start) < minSeconds);
+
+    return secondsSince(start) * 1e9 / operations;
+}
+
+// Written by the microbenchmarks so that their work is never optimized out
+static volatile uint64_t sink;
+
+static void benchState(const BenchOptions &options, const std::vector<rubik::CubeState> &states,
+                       std::vector<BenchResult> &results)
+{
+    // Every instruction set of the CPU, the default one without suffix
+    const rubik::SimdLevel detected = rubik::getSimdLevel();
+    std::vector<rubik::SimdLevel> levels = {detected};
+    for (rubik::SimdLevel level : {rubik::SimdLevel::SCALAR, rubik::SimdLevel::SSSE3, rubik::SimdLevel::AVX2})
+    {
+        if (level != detected && rubik::setSimdLevel(level))
+            levels.push_back(level);
+    }
+
+    for (rubik::SimdLevel level : levels)
+    {
+        rubik::setSimdLevel(level);
+        std::string suffix = level == detected ? "" : std::string(".") + rubik::simdLevelName(level);
+
+        results.push_back({"state.apply_move" + suffix, timePerOperation(options.minSeconds, [&]()
+                                                                         {
+            uint64_t checksum = 0;
+            for (const rubik::CubeState &state : states)
+            {
+                rubik::CubeState current = state;
+                for (uint8_t m = 0; m < rubik::NUM_POSSIBLE_MOVES; m++)
+                {
+                    current.applyMoveInPlace(rubik::Move(m));
+                    checksum += current[m];
+                }
+            }
+            sink = checksum;
+            return states.size() * rubik::NUM_POSSIBLE_MOVES; }),
+                           "ns"});
+
+        for (unsigned int phase = 0; phase < rubik::THISTLETHWAITE_KOCIEMBA_PHASE_COUNT; phase++)
+        {
+            // Only the first phase has a vector version
+            if (phase != 0 && level != detected)
+                continue;
+
+            results.push_back({"state.metrics.phase" + std::to_string(phase) + suffix,
+                               timePerOperation(options.minSeconds, [&]()
+                                                {
+                uint64_t checksum = 0;
+                for (const rubik::CubeState &state : states)
+                    checksum += state.thistlethwaiteKociembaId(phase).m1;
+                sink = checksum;
+                return states.size(); }),
+                               "ns"});
+        }
+    }
+
+    rubik::setSimdLevel(detected);
+
+    // Child state and metrics of a block of states, per child
+    std::vector<rubik::StateBlock> blocks((states.size() + rubik::STATE_BLOCK_SIZE - 1) / rubik::STATE_BLOCK_SIZE,
+                                         rubik::StateBlock{});
+    for (size_t i = 0; i < states.size(); i++)
+        blocks[i / rubik::STATE_BLOCK_SIZE].set(i % rubik::STATE_BLOCK_SIZE, states[i]);
+
+    for (unsigned int phase = 0; phase < rubik::THISTLETHWAITE_KOCIEMBA_PHASE_COUNT; phase++)
+    {
+        results.push_back({"state.expand_block.phase" + std::to_string(phase),
+                           timePerOperation(options.minSeconds, [&]()
+                                            {
+            uint64_t checksum = 0;
+            rubik::StateBlock children;
+            rubik::MetricsBlock metrics;
+            for (const rubik::StateBlock &block : blocks)
+            {
+                for (uint8_t m = 0; m < rubik::NUM_POSSIBLE_MOVES; m++)
+                {
+                    rubik::expandBlock(block, rubik::Move(m), phase, children, metrics);
+                    checksum += metrics.m1[m];
+                }
+            }
+            sink = checksum;
+            return blocks.size() * rubik::STATE_BLOCK_SIZE * rubik::NUM_POSSIBLE_MOVES; }),
+                           "ns"});
+    }
+}
+
+/**
+ * Child metrics from the move tables, to compare with computing them on the cubies
+ * (state.apply_move + state.metrics).
+ */
+static void benchCoordinates(const BenchOptions &options, const std::vector<rubik::CubeState> &states,
+                             std::vector<BenchResult> &results)
+{
+    const rubik::MoveTables &tables = rubik::MoveTables::getInstance();
+
+    for (unsigned int phase = 0; phase < rubik::THISTLETHWAITE_KOCIEMBA_PHASE_COUNT; phase++)
+    {
+        std::vector<rubik::TKMetrics> metrics;
+        for (const rubik::CubeState &state : states)
+            metrics.push_back(state.thistlethwaiteKociembaId(phase));
+
+        results.push_back({"coordinates.child_metrics.phase" + std::to_string(phase),
+                           timePerOperation(options.minSeconds, [&]()
+                                            {
+            uint64_t checksum = 0;
+            for (const rubik::TKMetrics &parent : metrics)
+            {
+                for (uint8_t m = 0; m < rubik::NUM_POSSIBLE_MOVES; m++)
+                {
+                    if (rubik::THISTLETHWAITE_MOVES[phase] & (1 << m))
+                        checksum += tables.applyMove(phase, parent, rubik::Move(m)).m2;
+                }
+            }
+            sink = checksum;
+            return metrics.size() * std::popcount(rubik::THISTLETHWAITE_MOVES[phase]); }),
+                           "ns"});
+
+        results.push_back({"state.child_metrics.phase" + std::to_string(phase),
+                           timePerOperation(options.minSeconds, [&]()
+                                            {
+            uint64_t checksum = 0;
+            for (const rubik::CubeState &state : states)
+            {
+                for (uint8_t m = 0; m < rubik::NUM_POSSIBLE_MOVES; m++)
+                {
+                    if (rubik::THISTLETHWAITE_MOVES[phase] & (1 << m))
+                        checksum += state.applyMove(rubik::Move(m)).thistlethwaiteKociembaId(phase).m2;
+                }
+            }
+            sink = checksum;
+            return states.size() * std::popcount(rubik::THISTLETHWAITE_MOVES[phase]); }),
+                           "ns"});
+    }
+}
+
+/**
+ * Lehmer rank with the comparison loops the coordinates used before permutation.h.
+ */
+static uint32_t permutationRankLoops(const uint8_t *values, unsigned int n)
+{
+    uint32_t rank = 0;
+
+    for (unsigned int i = n - 1; i >= 1; i--)
+    {
+        for (unsigned int j = 0; j < i; j++)
+            rank += values[i] < values[j];
+
+        rank *= i;
+    }
+
+    return rank;
+}
+
+/**
+ * Ranking and unranking of 4, 8 and 12 element permutations, against the loops.
+ */
+static void benchPermutations(const BenchOptions &options, std::vector<BenchResult> &results)
+{
+    std::mt19937 generator(options.seed);
+
+    for (unsigned int n : {4u, 8u, 12u})
+    {
+        std::vector<std::array<uint8_t, rubik::MAX_RANKED_ELEMENTS>> permutations(4096);
+        std::vector<uint32_t> ranks;
+        for (std::array<uint8_t, rubik::MAX_RANKED_ELEMENTS> &permutation : permutations)
+        {
+            ranks.push_back(generator() % rubik::FACTORIALS[n]);
+            rubik::permutationUnrank(ranks.back(), n, 0, permutation.data());
+        }
+
+        const std::string suffix = "." + std::to_string(n);
+
+        results.push_back({"coordinates.permutation_rank" + suffix, timePerOperation(options.minSeconds, [&]()
+                                                                                      {
+            uint64_t checksum = 0;
+            for (const std::array<uint8_t, rubik::MAX_RANKED_ELEMENTS> &permutation : permutations)
+                checksum += rubik::permutationRank(permutation.data(), n);
+            sink = checksum;
+            return permutations.size(); }),
+                           "ns"});
+
+        results.push_back({"coordinates.permutation_rank_loops" + suffix, timePerOperation(options.minSeconds, [&]()
+                                                                                            {
+            uint64_t checksum = 0;
+            for (const std::array<uint8_t, rubik::MAX_RANKED_ELEMENTS> &permutation : permutations)
+                checksum += permutationRankLoops(permutation.data(), n);
+            sink = checksum;
+            return permutations.size(); }),
+                           "ns"});
+
+        results.push_back({"coordinates.permutation_unrank" + suffix, timePerOperation(options.minSeconds, [&]()
+                                                                                        {
+            uint64_t checksum = 0;
+            uint8_t values[rubik::MAX_RANKED_ELEMENTS];
+            for (uint32_t rank : ranks)
+            {
+                rubik::permutationUnrank(rank, n, 0, values);
+                checksum += values[0];
+            }
+            sink = checksum;
+            return ranks.size(); }),
+                           "ns"});
+    }
+}
+
+static void benchOptimize(const BenchOptions &options, const std::vector<std::vector<rubik::Move>> &scrambles,
+                          std::vector<BenchResult> &results)
+{
+    // Raw phase algorithms often end and start on the same axis, join pairs of scrambles to get some
+    std::vector<std::vector<rubik::Move>> algorithms;
+    for (size_t i = 0; i + 1 < scrambles.size(); i++)
+    {
+        std::vector<rubik::Move> algorithm = scrambles[i];
+        algorithm.insert(algorithm.end(), scrambles[i + 1].begin(), scrambles[i + 1].end());
+        algorithms.push_back(algorithm);
+    }
+
+    results.push_back({"optimize.solution", timePerOperation(options.minSeconds, [&]()
+                                                             {
+        uint64_t checksum = 0;
+        for (const std::vector<rubik::Move> &algorithm : algorithms)
+            checksum += rubik::optimizeSolution(algorithm).size();
+        sink = checksum;
+        return algorithms.size(); }),
+                       "ns"});
+}
+
+/**
+ * Solve the corpus one state at a time and add up the reports of every phase.
+ */
+static void benchSolves(const std::string &name, const rubik::SolverOptions &solverOptions,
+                        const std::vector<rubik::CubeState> &states, std::vector<BenchResult> &results)
+{
+    std::vector<double> phaseSeconds;
+    std::vector<double> phaseNodes;
+    double seconds = 0.0, moves = 0.0, peakVisited = 0.0, nodes = 0.0;
+    rubik::SearchScratch scratch;
+
+    for (const rubik::CubeState &state : states)
+    {
+        rubik::SolveReport report = rubik::solveState(state, solverOptions, nullptr, &scratch);
+        moves += report.solution.size();
+        seconds += report.seconds;
+        peakVisited = std::max(peakVisited, double(report.peakVisited));
+
+        phaseSeconds.resize(report.phases.size());
+        phaseNodes.resize(report.phases.size());
+        for (size_t p = 0; p < report.phases.size(); p++)
+        {
+            phaseSeconds[p] += report.phases[p].seconds;
+            phaseNodes[p] += report.phases[p].nodes;
+            nodes += report.phases[p].nodes;
+        }
+    }
+
+    results.push_back({name + ".seconds", seconds, "s"});
+    results.push_back({name + ".moves", moves / states.size(), "moves"});
+    results.push_back({name + ".peak_visited", peakVisited, "states"});
+    results.push_back({name + ".scratch_bytes", double(scratch.bytes()), "bytes"});
+    if (nodes > 0)
+        results.push_back({name + ".ns_per_node", seconds * 1e9 / nodes, "ns"});
+
+    for (size_t p = 0; p < phaseSeconds.size(); p++)
+    {
+        results.push_back({name + ".phase" + std::to_string(p) + ".seconds", phaseSeconds[p], "s"});
+        results.push_back({name + ".phase" + std::to_string(p) + ".nodes", phaseNodes[p], "nodes"});
+    }
+}
+
+static void benchHybrid(const BenchOptions &options, const std::vector<rubik::CubeState> &states,
+                        std::vector<BenchResult> &results)
+{
+    rubik::SolverOptions solverOptions;
+    benchSolves("hybrid", solverOptions, states, results);
+
+    // Each search improvement against its previous version
+    rubik::SolverOptions interleaved;
+    interleaved.layeredSearch = false;
+    benchSolves("hybrid_interleaved", interleaved, states, results);
+
+    rubik::SolverOptions cubies;
+    cubies.incrementalMetrics = false;
+    benchSolves("hybrid_cubies", cubies, states, results);
+
+    rubik::SolverOptions unblocked = cubies;
+    unblocked.blockExpansion = false;
+    benchSolves("hybrid_unblocked", unblocked, states, results);
+
+    rubik::SolverOptions unpruned;
+    unpruned.canonicalPruning = false;
+    benchSolves("hybrid_unpruned", unpruned, states, results);
+
+    // Goal side read from the precomputed layers, built or mapped by a first solve
+    rubik::SolverOptions goalLayers;
+    goalLayers.goalDepth = 6;
+    rubik::solveState(states.front(), goalLayers);
+    benchSolves("hybrid_goal_layers", goalLayers, states, results);
+
+    // Same search with the portable code, to see the gain of the vector kernels
+    const rubik::SimdLevel detected = rubik::getSimdLevel();
+    if (detected != rubik::SimdLevel::SCALAR)
+    {
+        rubik::setSimdLevel(rubik::SimdLevel::SCALAR);
+        benchSolves("hybrid_scalar", unblocked, states, results);
+        rubik::setSimdLevel(detected);
+    }
+
+    rubik::SolverOptions parallel;
+    parallel.searchThreads = options.searchThreads != 0 ? options.searchThreads
+                                                        : std::max(2u, std::thread::hardware_concurrency());
+    benchSolves("hybrid_parallel", parallel, states, results);
+}
+
+static void benchKociemba(const std::vector<rubik::CubeState> &states, std::vector<BenchResult> &results)
+{
+    rubik::SolverOptions solverOptions;
+    solverOptions.engine = rubik::SolverEngine::KOCIEMBA;
+
+    // The first solve builds or maps the tables
+    rubik::solveState(rubik::CubeState().applyMove(rubik::Move(0)), solverOptions);
+
+    benchSolves("kociemba", solverOptions, states, results);
+}
+
+static void benchThistlethwaite(const std::vector<rubik::CubeState> &states, std::vector<BenchResult> &results)
+{
+    rubik::SolverOptions solverOptions;
+    solverOptions.engine = rubik::SolverEngine::THISTLETHWAITE;
+
+    // The first solve builds or maps the tables
+    rubik::solveState(rubik::CubeState().applyMove(rubik::Move(0)), solverOptions);
+
+    benchSolves("thistlethwaite", solverOptions, states, results);
+}
+
+/**
+ * Length of the near-optimal solutions, each one improved for the default time.
+ */
+static void benchNearOptimal(const std::vector<rubik::CubeState> &states, std::vector<BenchResult> &results)
+{
+    rubik::SolverOptions solverOptions;
+    solverOptions.engine = rubik::SolverEngine::NEAR_OPTIMAL;
+
+    // The first solve builds or maps the pruning tables of the first phase
+    rubik::solveState(rubik::CubeState().applyMove(rubik::Move(0)), solverOptions);
+
+    benchSolves("near_optimal", solverOptions, states, results);
+}
+
+/**
+ * Time to the optimal solution of shorter scrambles, random states take minutes each.
+ */
+static void benchOptimal(const BenchOptions &options, std::vector<BenchResult> &results)
+{
+    std::vector<rubik::CubeState> states = toStates(makeScrambles(options.scrambles, options.optimalLength, options.seed + 2));
+
+    rubik::SolverOptions solverOptions;
+    solverOptions.engine = rubik::SolverEngine::OPTIMAL;
+
+    // The first solve builds or maps the pattern databases
+    rubik::solveState(rubik::CubeState().applyMove(rubik::Move(0)), solverOptions);
+
+    benchSolves("optimal", solverOptions, states, results);
+}
+
+/**
+ * Wall time of solveMany on a large corpus with 1, 2, 4, 8 and all hardware threads.
+ */
+static void benchScaling(const BenchOptions &options, std::vector<BenchResult> &results)
+{
+    std::vector<rubik::CubeState> corpus = toStates(makeScrambles(options.corpus, options.scrambleLength, options.seed + 1));
+
+    rubik::SolverOptions solverOptions;
+    solverOptions.engine = rubik::SolverEngine::KOCIEMBA;
+    rubik::solveState(rubik::CubeState().applyMove(rubik::Move(0)), solverOptions);
+
+    std::vector<unsigned int> threadCounts = {1, 2, 4, 8};
+    unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+    if (std::find(threadCounts.begin(), threadCounts.end(), hardware) == threadCounts.end())
+        threadCounts.push_back(hardware);
+
+    for (unsigned int threads : threadCounts)
+    {
+        rubik::ThreadPool pool(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        rubik::solveMany(corpus, solverOptions, pool);
+
+        results.push_back({"scaling.threads" + std::to_string(threads) + ".seconds", secondsSince(start), "s"});
+    }
+}
+
+static void writeResults(std::ostream &s, const BenchOptions &options, const std::vector<BenchResult> &results)
+{
+    s << "{\n  \"seed\": " << options.seed
+      << ",\n  \"scrambles\": " << options.scrambles
+      << ",\n  \"length\": " << options.scrambleLength
+      << ",\n  \"hardware_threads\": " << std::thread::hardware_concurrency()
+      << ",\n  \"simd\": \"" << rubik::simdLevelName(rubik::getSimdLevel()) << "\""
+      << ",\n  \"results\": [\n";
+
+    for (size_t r = 0; r < results.size(); r++)
+    {
+        s << "    {\"name\": \"" << results[r].name << "\", \"value\": " << std::setprecision(10) << results[r].value
+          << ", \"unit\": \"" << results[r].unit << "\"}" << (r + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    s << "  ]\n}" << std::endl;
+}
+
+/**
+ * Read the name and value of every result of a previous output.
+ * Only understands the format written by writeResults.
+ */
+static std::map<std::string, double> readBaseline(std::istream &s)
+{
+    std::map<std::string, double> baseline;
+    std::string text((std::istreambuf_iterator<char>(s)), std::istreambuf_iterator<char>());
+
+    const std::string nameKey = "\"name\": \"", valueKey = "\"value\": ";
+    size_t position = 0;
+
+    while ((position = text.find(nameKey, position)) != std::string::npos)
+    {
+        size_t nameStart = position + nameKey.size();
+        size_t nameEnd = text.find('"', nameStart);
+        size_t valueStart = text.find(valueKey, nameEnd);
+
+        if (nameEnd == std::string::npos || valueStart == std::string::npos)
+            break;
+
+        valueStart += valueKey.size();
+        baseline[text.substr(nameStart, nameEnd - nameStart)] = std::strtod(text.c_str() + valueStart, nullptr);
+        position = valueStart;
+    }
+
+    return baseline;
+}
+
+/**
+ * Print every result next to its baseline.
+ * @return the number of results slower than the baseline by more than the threshold
+ */
+static int compareResults(const std::vector<BenchResult> &results, const std::map<std::string, double> &baseline,
+                          double threshold)
+{
+    int regressions = 0;
+
+    std::cerr << std::left << std::setw(44) << "Benchmark" << std::right << std::setw(14) << "Baseline"
+              << std::setw(14) << "Current" << std::setw(10) << "Change" << std::endl;
+
+    for (const BenchResult &result : results)
+    {
+        auto known = baseline.find(result.name);
+        if (known == baseline.end() || known->second <= 0.0)
+            continue;
+
+        double change = (result.value - known->second) / known->second * 100.0;
+        bool regression = change > threshold;
+        regressions += regression;
+
+        std::cerr << std::left << std::setw(44) << result.name << std::right << std::setprecision(4)
+                  << std::setw(14) << known->second << std::setw(14) << result.value
+                  << std::setw(9) << std::fixed << std::setprecision(1) << change << "%"
+                  << (regression ? "  REGRESSION" : "") << std::defaultfloat << std::endl;
+    }
+
+    return regressions;
+}
+
+static std::vector<std::string> splitGroups(const std::string &text)
+{
+    std::vector<std::string> groups;
+    std::stringstream stream(text);
+    std::string group;
+
+    while (std::getline(stream, group, ','))
+        groups.push_back(group);
+
+    return groups;
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    std::string outputPath, baselinePath;
+    double threshold = 10.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if (argument == "/?" || argument == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (argument == "--seed" && i + 1 < argc)
+        {
+            options.seed = std::stoi(argv[++i]);
+        }
+        else if (argument == "--scrambles" && i + 1 < argc)
+        {
+            options.scrambles = std::max(2, std::stoi(argv[++i]));
+        }
+        else if (argument == "--length" && i + 1 < argc)
+        {
+            options.scrambleLength = std::stoi(argv[++i]);
+        }
+        else if (argument == "--corpus" && i + 1 < argc)
+        {
+            options.corpus = std::stoi(argv[++i]);
+        }
+        else if (argument == "--optimal-length" && i + 1 < argc)
+        {
+            options.optimalLength = std::stoi(argv[++i]);
+        }
+        else if (argument == "--search-threads" && i + 1 < argc)
+        {
+            options.searchThreads = std::stoi(argv[++i]);
+        }
+        else if (argument == "--only" && i + 1 < argc)
+        {
+            options.groups = splitGroups(argv[++i]);
+        }
+        else if (argument == "--out" && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+        }
+        else if (argument == "--baseline" && i + 1 < argc)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (argument == "--threshold" && i + 1 < argc)
+        {
+            threshold = std::stod(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "ERROR: Unknown option " << argument << "." << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty())
+    {
+        std::ifstream file(baselinePath);
+        if (!file.is_open())
+        {
+            std::cerr << "ERROR: The baseline file (" << baselinePath << ") cannot be found." << std::endl;
+            return 1;
+        }
+        baseline = readBaseline(file);
+    }
+
+    auto selected = [&](const std::string &group)
+    {
+        return options.groups.empty() ||
+               std::find(options.groups.begin(), options.groups.end(), group) != options.groups.end();
+    };
+
+    std::vector<std::vector<rubik::Move>> scrambles = makeScrambles(options.scrambles, options.scrambleLength, options.seed);
+    std::vector<rubik::CubeState> states = toStates(scrambles);
+    std::vector<BenchResult> results;
+
+    if (selected("state"))
+        benchState(options, states, results);
+    if (selected("coordinates"))
+    {
+        benchCoordinates(options, states, results);
+        benchPermutations(options, results);
+    }
+    if (selected("optimize"))
+        benchOptimize(options, scrambles, results);
+    if (selected("hybrid"))
+        benchHybrid(options, states, results);
+    if (selected("kociemba"))
+        benchKociemba(states, results);
+    if (selected("thistlethwaite"))
+        benchThistlethwaite(states, results);
+    if (selected("optimal"))
+        benchOptimal(options, results);
+    if (selected("near_optimal"))
+        benchNearOptimal(states, results);
+    if (selected("scaling"))
+        benchScaling(options, results);
+
+    rubik::printTableLoadSummary(std::cerr);
+
+    if (outputPath.empty())
+    {
+        writeResults(std::cout, options, results);
+    }
+    else
+    {
+        std::ofstream file(outputPath);
+        writeResults(file, options, results);
+    }
+
+    if (!baselinePath.empty() && compareResults(results, baseline, threshold) > 0)
+        return 2;
+
+    return 0;
+}
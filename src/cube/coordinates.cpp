@@ -0,0 +1,354 @@
+#include "cube/coordinates.h"
+#include "cube/permutation.h"
+
+#include <queue>
+
+namespace rubik
+{
+	/**
+	 * Orientation of the first 7 corners in base 3. The last one is implied.
+	 */
+	uint16_t cornerTwist(const CubeState &state)
+	{
+		uint16_t twist = 0;
+
+		for (int c = 0; c < NUM_CORNERS - 1; c++)
+		{
+			twist = twist * 3 + state[TOTAL_NUM_CUBIES + NUM_EDGES + c];
+		}
+
+		return twist;
+	}
+
+	/**
+	 * Orientation of the first 11 edges in base 2. The last one is implied.
+	 */
+	uint16_t edgeFlip(const CubeState &state)
+	{
+		uint16_t flip = 0;
+
+		for (int e = 0; e < NUM_EDGES - 1; e++)
+		{
+			flip = flip * 2 + state[TOTAL_NUM_CUBIES + e];
+		}
+
+		return flip;
+	}
+
+	/**
+	 * Positions holding the edges that belong in the middle slice.
+	 */
+	uint16_t sliceCombination(const CubeState &state)
+	{
+		uint32_t marked = 0;
+
+		for (int e = 0; e < NUM_EDGES; e++)
+			marked |= uint32_t(state[e] >= NUM_EDGES - NUM_MIDDLE_EDGES) << e;
+
+		return combinationRank(marked);
+	}
+
+	/**
+	 * Rough orientation of the F, B, L and R centers. Must be a half-turn
+	 * away from solved.
+	 */
+	uint16_t sideCenterParity(const CubeState &state)
+	{
+		uint16_t parity = 0;
+
+		for (int c = 2; c < NUM_CENTERS; c++)
+		{
+			parity = parity * 2 + (state[2 * TOTAL_NUM_CUBIES + c] & 0b1);
+		}
+
+		return parity;
+	}
+
+	/**
+	 * Positions holding the odd top and bottom edges (UR, UL, DR and DL).
+	 * They must end up on odd positions, a half-turn away from solved.
+	 */
+	uint16_t edgeTetrad(const CubeState &state)
+	{
+		uint32_t marked = 0;
+
+		for (int e = 0; e < NUM_EDGES; e++)
+			marked |= uint32_t(state[e] < NUM_EDGES - NUM_MIDDLE_EDGES && (state[e] & 0b1)) << e;
+
+		return combinationRank(marked);
+	}
+
+	/**
+	 * Placement of the four pairs of corners sharing a slice and a diagonal.
+	 * The pair of a corner is given by its first bit (diagonal L->R/F->B) and
+	 * its third bit (bottom slice).
+	 */
+	uint16_t cornerTetrad(const CubeState &state)
+	{
+		bool remaining[NUM_CORNERS];
+		int pairs[NUM_CORNERS];
+
+		for (int c = 0; c < NUM_CORNERS; c++)
+		{
+			int corner = state[c + NUM_EDGES] - NUM_EDGES;
+			pairs[c] = (corner & 0b1) | ((corner >> 2) << 1);
+			remaining[c] = true;
+		}
+
+		uint16_t rank = 0;
+
+		// The position of the last pair is implied by the three others.
+		for (int p = 0; p < 3; p++)
+		{
+			uint32_t marked = 0;
+			int n = 0;
+
+			for (int c = 0; c < NUM_CORNERS; c++)
+			{
+				if (remaining[c])
+				{
+					marked |= uint32_t(pairs[c] == p) << n++;
+					remaining[c] = (pairs[c] != p);
+				}
+			}
+
+			rank = rank * binomial(n, 2) + combinationRank(marked);
+		}
+
+		return rank;
+	}
+
+	/**
+	 * Check if the number of permutations between corners is even.
+	 * From a solved state, if pairs of corners where swapped an odd
+	 * number of times, this will be a '1' and if the number of times
+	 * was even, this will be a '0'.
+	 */
+	uint16_t cornerParity(const CubeState &state)
+	{
+		return permutationParity(state.data() + NUM_EDGES, NUM_CORNERS);
+	}
+
+	/**
+	 * Rank of the permutation of the corners.
+	 */
+	uint16_t cornerPermutation(const CubeState &state)
+	{
+		return permutationRank(state.data() + NUM_EDGES, NUM_CORNERS);
+	}
+
+	/**
+	 * Rank of the permutation of the top and bottom edges.
+	 * Only valid when these edges are out of the middle slice.
+	 */
+	uint16_t edgePermutation(const CubeState &state)
+	{
+		return permutationRank(state.data(), NUM_EDGES - NUM_MIDDLE_EDGES);
+	}
+
+	/**
+	 * Rank of the permutation of the middle slice edges.
+	 * Only valid when these edges are in the middle slice.
+	 */
+	uint16_t slicePermutation(const CubeState &state)
+	{
+		return permutationRank(state.data() + NUM_EDGES - NUM_MIDDLE_EDGES, NUM_MIDDLE_EDGES);
+	}
+
+	/**
+	 * Rough orientation of the U and D centers.
+	 */
+	uint16_t udCenterParity(const CubeState &state)
+	{
+		uint16_t parity = 0;
+
+		for (int c = 0; c < 2; c++)
+		{
+			parity = parity * 2 + (state[2 * TOTAL_NUM_CUBIES + c] & 0b1);
+		}
+
+		return parity;
+	}
+
+	/**
+	 * Compute any coordinate from the cubies.
+	 * @param coordinate - coordinate to compute
+	 * @param state - state to look at
+	 */
+	uint16_t computeCoordinate(Coordinate coordinate, const CubeState &state)
+	{
+		switch (coordinate)
+		{
+		case CORNER_TWIST:
+			return cornerTwist(state);
+		case EDGE_FLIP:
+			return edgeFlip(state);
+		case SLICE_COMBINATION:
+			return sliceCombination(state);
+		case SIDE_CENTER_PARITY:
+			return sideCenterParity(state);
+		case EDGE_TETRAD:
+			return edgeTetrad(state);
+		case CORNER_TETRAD:
+			return cornerTetrad(state);
+		case CORNER_PARITY:
+			return cornerParity(state);
+		case CORNER_PERMUTATION:
+			return cornerPermutation(state);
+		case EDGE_PERMUTATION:
+			return edgePermutation(state);
+		case SLICE_PERMUTATION:
+			return slicePermutation(state);
+		case UD_CENTER_PARITY:
+			return udCenterParity(state);
+		default:
+			return 0;
+		}
+	}
+
+	/**
+	 * @return the colexicographic rank of every subset of the 12 edge positions
+	 */
+	const uint16_t *getCombinationRanks()
+	{
+		static const std::vector<uint16_t> ranks = []()
+		{
+			std::vector<uint16_t> table(1 << NUM_EDGES);
+
+			for (unsigned int set = 0; set < table.size(); set++)
+				table[set] = combinationRank(set);
+
+			return table;
+		}();
+
+		return ranks.data();
+	}
+
+	/**
+	 * @return the corner tetrad of every placement of the pairs, evaluated on a state
+	 * holding a corner of the right pair at each position
+	 */
+	const uint16_t *getCornerTetrads()
+	{
+		static const std::vector<uint16_t> tetrads = []()
+		{
+			std::vector<uint16_t> table(1 << (2 * NUM_CORNERS));
+			std::array<uint8_t, PACKED_STATE_SIZE> cubies{};
+
+			for (unsigned int pairs = 0; pairs < table.size(); pairs++)
+			{
+				for (int c = 0; c < NUM_CORNERS; c++)
+				{
+					int pair = (pairs >> (2 * c)) & 0b11;
+					cubies[NUM_EDGES + c] = NUM_EDGES + ((pair & 0b1) | ((pair >> 1) << 2));
+				}
+
+				table[pairs] = cornerTetrad(CubeState(cubies));
+			}
+
+			return table;
+		}();
+
+		return tetrads.data();
+	}
+
+	/**
+	 * Fill the transition table of a coordinate with a breadth-first search from the
+	 * solved state, keeping one representative state for every value reached.
+	 * @param coordinate - coordinate to tabulate
+	 * @param legalMoves - moves that keep the coordinate inside its domain
+	 */
+	static std::vector<uint16_t> buildMoveTable(Coordinate coordinate, unsigned int legalMoves)
+	{
+		const unsigned int size = COORDINATE_SIZES[coordinate];
+
+		std::vector<uint16_t> table(size * NUM_POSSIBLE_MOVES, INVALID_COORDINATE);
+		std::vector<bool> reached(size, false);
+
+		std::queue<CubeState> q;
+		CubeState solved;
+		q.push(solved);
+		reached[computeCoordinate(coordinate, solved)] = true;
+
+		while (!q.empty())
+		{
+			CubeState representative = q.front();
+			q.pop();
+
+			uint16_t value = computeCoordinate(coordinate, representative);
+
+			for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES; m++)
+			{
+				if (legalMoves & (1 << m))
+				{
+					CubeState child = representative.applyMove(Move(m));
+					uint16_t childValue = computeCoordinate(coordinate, child);
+
+					table[value * NUM_POSSIBLE_MOVES + m] = childValue;
+
+					if (!reached[childValue])
+					{
+						reached[childValue] = true;
+						q.push(child);
+					}
+				}
+			}
+		}
+
+		return table;
+	}
+
+	MoveTables::MoveTables()
+	{
+		for (int c = 0; c < COORDINATE_COUNT; c++)
+		{
+			Coordinate coordinate = Coordinate(c);
+
+			// The permutations of the edges are only defined while the middle
+			// edges stay in their slice.
+			unsigned int legalMoves = (coordinate == EDGE_PERMUTATION || coordinate == SLICE_PERMUTATION)
+										  ? KOCIEMBA_MOVES[1]
+										  : KOCIEMBA_MOVES[0];
+
+			size_t bytes = COORDINATE_SIZES[c] * NUM_POSSIBLE_MOVES * sizeof(uint16_t);
+
+			_files[c] = loadOrBuildTable(std::string("move_") + COORDINATE_NAMES[c], bytes, [=]()
+										 {
+				std::vector<uint16_t> table = buildMoveTable(coordinate, legalMoves);
+				const uint8_t *raw = reinterpret_cast<const uint8_t *>(table.data());
+				return std::vector<uint8_t>(raw, raw + table.size() * sizeof(uint16_t)); });
+
+			_tables[c] = reinterpret_cast<const uint16_t *>(_files[c].data());
+		}
+	}
+
+	/**
+	 * Access the tables, building them on the first call.
+	 */
+	const MoveTables &MoveTables::getInstance()
+	{
+		static const MoveTables instance;
+		return instance;
+	}
+
+	/**
+	 * Find the metrics of a child directly from the metrics of its parent.
+	 * @param phase - current phase of the algorithm
+	 * @param metrics - metrics of the parent
+	 * @param move - move applied to the parent
+	 */
+	TKMetrics MoveTables::applyMove(unsigned int phase, const TKMetrics &metrics, const Move &move) const
+	{
+		if (phase == 0)
+			return updateMetrics<0>(metrics, move);
+		else if (phase == 1)
+			return updateMetrics<1>(metrics, move);
+
+		return updateMetrics<2>(metrics, move);
+	}
+
+	const uint16_t *MoveTables::getTable(Coordinate coordinate) const
+	{
+		return _tables[coordinate];
+	}
+}
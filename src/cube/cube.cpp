@@ -3,19 +3,27 @@
 #include "cube/solver.h"
 #include "logging/algoparser.h"
 
+#include <algorithm>
+
 namespace rubik
 {
 
 	Cube::Cube(CubeType type) : _model(CubeModel(type)), _state(), _type(type),
-								_centerOrientation(type == CubeType::SPLIT) {}
+								_centerOrientation(type == CubeType::SPLIT), _bestLength(0) {}
 
 	Cube::Cube() : Cube(CubeType::REGULAR) {}
 
 	/**
-	 * Update the orientation of the cube.
+	 * Update the orientation of the cube, turn the moves found by the solver and
+	 * collect its report once it is done.
 	 */
 	void Cube::update()
 	{
+		turnSolvedMoves();
+
+		if (_job && _job->isDone())
+			finishSolve();
+
 		_model.update();
 	}
 
@@ -36,7 +44,7 @@ namespace rubik
 	void Cube::turnFace(const Move move)
 	{
 		_model.turnFace(move);
-		_state = _state.applyMove(move);
+		_state.applyMoveInPlace(move);
 	}
 
 	/**
@@ -49,32 +57,77 @@ namespace rubik
 	}
 
 	/**
-	 * Find the solution of the current position and execute it.
+	 * Start solving the current position in the background. The moves are turned by
+	 * update as the solver finds them.
 	 */
 	void Cube::solve()
 	{
-		_solving = true;
+		if (_job)
+			return;
+
+		SolverOptions options = _solverOptions;
 
-		std::queue<Move> solution = thistlethwaiteKociemba(this, _state);
+		// Only the hybrid algorithm and its near-optimal mode solve the centers, the other
+		// ones cannot be used when their orientation matters.
+		if (_centerOrientation && options.engine != SolverEngine::NEAR_OPTIMAL)
+			options.engine = SolverEngine::THISTLETHWAITE_KOCIEMBA;
 
-		// Show the solution in the terminal
-		if (!solution.empty())
+		// Shown by the application while the near-optimal job runs
+		_bestLength = 0;
+		options.onImprovement = [this](const std::vector<Move> &solution) { _bestLength = solution.size(); };
+
+		_job = std::make_unique<SolverJob>(_state, options, [this](const Move &move)
+										   {
+			std::lock_guard<std::mutex> lock(_solvedMovesMutex);
+			_solvedMoves.push(move); });
+	}
+
+	/**
+	 * Stop the solve in progress. The phases it completed are still turned.
+	 */
+	void Cube::cancelSolve()
+	{
+		if (_job)
+			_job->cancel();
+	}
+
+	/**
+	 * Turn the moves the solver job found since the last frame.
+	 */
+	void Cube::turnSolvedMoves()
+	{
+		std::lock_guard<std::mutex> lock(_solvedMovesMutex);
+
+		while (!_solvedMoves.empty())
 		{
-			parsing::saveProblem(std::string(DIRECTORY_PATH) + "/res/Algorithms/current.algo", solution);
-			std::cout << "<SOLUTION> " << solution.size() << " moves: ";
+			turnFace(_solvedMoves.front());
+			_solvedMoves.pop();
+		}
+	}
 
-			while (solution.size() > 0)
-			{
-				Move move = solution.front();
-				std::cout << move << " ";
-				// turnFace(move);
-				solution.pop();
-			}
+	/**
+	 * Show the report of the finished job, save its solution and orient the centers.
+	 */
+	void Cube::finishSolve()
+	{
+		SolveReport report = _job->getReport().get();
+		_job.reset();
+
+		// Moves given after the last frame
+		turnSolvedMoves();
+
+		printSolveReport(std::cout, report);
 
-			std::cout << std::endl;
+		if (!report.solution.empty())
+		{
+			std::queue<Move> solution;
+			for (const Move &move : report.solution)
+				solution.push(move);
+
+			parsing::saveProblem(std::string(DIRECTORY_PATH) + "/res/Algorithms/current.algo", solution);
 		}
 
-		if (_centerOrientation)
+		if (_centerOrientation && report.status == SolveStatus::SOLVED)
 		{
 			std::vector<Move> extra = solveCenters(_state);
 
@@ -88,13 +141,19 @@ namespace rubik
 				}
 			}
 		}
-
-		_solving = false;
 	}
 
 	bool Cube::isSolving()
 	{
-		return _solving;
+		return _job != nullptr;
+	}
+
+	/**
+	 * @return length of the shortest solution the near-optimal job found so far, 0 if none yet
+	 */
+	unsigned int Cube::getBestLength() const
+	{
+		return _bestLength;
 	}
 
 	/**
@@ -119,6 +178,44 @@ namespace rubik
 		_centerOrientation = newType == CubeType::SPLIT;
 	}
 
+	void Cube::setSolverEngine(SolverEngine engine)
+	{
+		_solverOptions.engine = engine;
+	}
+
+	SolverEngine Cube::getSolverEngine() const
+	{
+		return _solverOptions.engine;
+	}
+
+	/**
+	 * Set the number of threads expanding the frontiers of the hybrid solver.
+	 * @param threads - number of threads, 1 for the serial search
+	 */
+	void Cube::setSearchThreads(unsigned int threads)
+	{
+		_solverOptions.searchThreads = std::max(1u, threads);
+	}
+
+	unsigned int Cube::getSearchThreads() const
+	{
+		return _solverOptions.searchThreads;
+	}
+
+	/**
+	 * Bound the time of the next solves.
+	 * @param seconds - wall-clock budget of a solve, 0 for no limit
+	 */
+	void Cube::setTimeLimit(double seconds)
+	{
+		_solverOptions.timeLimit = std::max(0.0, seconds);
+	}
+
+	double Cube::getTimeLimit() const
+	{
+		return _solverOptions.timeLimit;
+	}
+
 	/**
 	 * Show the cube state for debugging purposes
 	 * @param cube - cube to show the state of
@@ -65,7 +65,7 @@ namespace rubik
 	{
 		if (_moves.size() > 0)
 		{
-			glm::vec4 axisAngle = _moves.front().toAxisAngle();
+			glm::vec4 axisAngle = toAxisAngle(_moves.front());
 
 			glm::vec3 axis = glm::vec3(axisAngle[0], axisAngle[1], axisAngle[2]);
 			float theta = axisAngle[3] / _FRAME_PER_MOVES;
@@ -137,7 +137,7 @@ namespace rubik
 
 			for (int c = 0; c < _cubies.size(); c++)
 			{
-				if (move.affectsPiece(_cubies[c].getNormals()))
+				if (affectsPiece(move, _cubies[c].getNormals()))
 					moveTargets.push_back(c);
 			}
 
@@ -160,4 +160,68 @@ namespace rubik
 
 		_splitted = (newType == CubeType::SPLIT);
 	}
+
+	/**
+	 * Get the rotation modification of the model.
+	 * @param move - move to animate
+	 * @return the axis to turn around and the angle to turn by
+	 */
+	glm::vec4 CubeModel::toAxisAngle(const Move &move)
+	{
+		glm::vec3 axis(0, 0, 0);
+
+		int face = move.getFace();
+		int turns = move.getTurns();
+
+		switch (face)
+		{
+		case 0:
+			axis[1] = 1;
+			break;
+		case 1:
+			axis[1] = -1;
+			break;
+		case 2:
+			axis[2] = 1;
+			break;
+		case 3:
+			axis[2] = -1;
+			break;
+		case 4:
+			axis[0] = -1;
+			break;
+		case 5:
+			axis[0] = 1;
+			break;
+		}
+
+		float angle = (turns - (4 * (turns == 3))) * M_PI / 2.0f;
+
+		return glm::vec4(axis, -angle);
+	}
+
+	/**
+	 * @param move - move to animate
+	 * @param normals - normals of the sides the cubie touches
+	 * @return if the piece is part of the side that turns
+	 */
+	bool CubeModel::affectsPiece(const Move &move, const std::vector<glm::vec3> &normals)
+	{
+		int face = move.getFace();
+
+		for (int i = 0; i < normals.size(); i++)
+		{
+			glm::vec3 normal = normals[i];
+
+			if ((face == 0 && normal[1] > 0) ||
+				(face == 1 && normal[1] < 0) ||
+				(face == 2 && normal[2] > 0) ||
+				(face == 3 && normal[2] < 0) ||
+				(face == 4 && normal[0] < 0) ||
+				(face == 5 && normal[0] > 0))
+				return true;
+		}
+
+		return false;
+	}
 }
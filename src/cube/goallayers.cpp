@@ -0,0 +1,160 @@
+#include "cube/goallayers.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cube/coordinates.h"
+
+namespace rubik
+{
+	/**
+	 * Breadth-first search of a phase from its goal, the backward half of the
+	 * bidirectional searches.
+	 * @param depth - number of layers explored
+	 * @return every state found with its distance to the goal and the move toward it
+	 */
+	template <unsigned int Phase>
+	static std::vector<GoalEntry> searchGoalSide(unsigned int depth)
+	{
+		const MoveTables &tables = MoveTables::getInstance();
+		const TKMetrics goalId = CubeState().phaseMetrics<Phase>();
+
+		VisitedTable visited;
+		visited[goalId].directionMove = 0x40;
+
+		std::vector<GoalEntry> entries(1, GoalEntry{packMetrics(goalId), 0, 0, {}});
+		std::vector<CoordinateNode> layer(1, CoordinateNode{goalId, 0x40, -1});
+		std::vector<CoordinateNode> next;
+
+		for (uint8_t d = 1; d <= depth && !layer.empty(); d++)
+		{
+			next.clear();
+
+			for (const CoordinateNode &node : layer)
+			{
+				const MoveList &legalMoves = PHASE_MOVE_LISTS<Phase, true>[node.lastFace + 1];
+
+				for (uint8_t i = 0; i < legalMoves.size; i++)
+				{
+					Move move(legalMoves.moves[i]);
+					TKMetrics newId = tables.updateMetrics<Phase>(node.id, move);
+					TKInformation &newInformation = visited[newId];
+
+					if (!newInformation.directionMove)
+					{
+						newInformation.directionMove = 0x40 | move.code();
+						entries.push_back(GoalEntry{packMetrics(newId), d, move.inverse().code(), {}});
+						next.push_back(CoordinateNode{newId, newInformation.directionMove, int8_t(move.getFace())});
+					}
+				}
+			}
+
+			layer.swap(next);
+		}
+
+		return entries;
+	}
+
+	/**
+	 * Hashed table of the goal side of a phase, as saved in its file.
+	 */
+	static std::vector<uint8_t> buildGoalLayers(unsigned int phase, unsigned int depth)
+	{
+		std::vector<GoalEntry> entries = phase == 0	  ? searchGoalSide<0>(depth)
+										 : phase == 1 ? searchGoalSide<1>(depth)
+													  : searchGoalSide<2>(depth);
+
+		// At most half full to keep the probes short
+		size_t capacity = 16;
+		while (capacity < 2 * entries.size())
+			capacity *= 2;
+
+		std::vector<uint8_t> bytes(capacity * sizeof(GoalEntry), 0);
+		GoalEntry *table = reinterpret_cast<GoalEntry *>(bytes.data());
+		for (size_t i = 0; i < capacity; i++)
+			table[i].key = EMPTY_GOAL_KEY;
+
+		for (const GoalEntry &entry : entries)
+		{
+			size_t index = hashMetricsKey(entry.key) & (capacity - 1);
+			while (table[index].key != EMPTY_GOAL_KEY)
+				index = (index + 1) & (capacity - 1);
+
+			table[index] = entry;
+		}
+
+		return bytes;
+	}
+
+	GoalLayers::GoalLayers(unsigned int phase, unsigned int depth)
+	{
+		MoveTables::getInstance();
+
+		// The size depends on the number of states found, the file gives it
+		_file = loadOrBuildTable("goal_layers_" + std::to_string(phase) + "_" + std::to_string(depth), 0, [=]()
+								 { return buildGoalLayers(phase, depth); });
+
+		_entries = reinterpret_cast<const GoalEntry *>(_file.data());
+		_mask = _file.size() / sizeof(GoalEntry) - 1;
+
+		_size = 0;
+		for (size_t i = 0; i <= _mask; i++)
+		{
+			const GoalEntry &entry = _entries[i];
+			if (entry.key == EMPTY_GOAL_KEY)
+				continue;
+
+			_size++;
+
+			// The move toward the goal turns the same face as the last move from it
+			if (entry.depth == depth)
+			{
+				TKMetrics id{uint16_t(entry.key), uint16_t(entry.key >> 16), uint16_t(entry.key >> 32),
+							 uint16_t(entry.key >> 48)};
+				_frontier.push_back(CoordinateNode{id, 0x40, int8_t(Move(entry.move).getFace())});
+			}
+		}
+	}
+
+	/**
+	 * Access the goal side of a phase, building it on the first call. Every solve
+	 * of the process shares the same tables.
+	 * @param phase - phase of the thistlethwaite-kociemba algorithm
+	 * @param depth - largest number of moves to the goal of the states kept
+	 */
+	const GoalLayers &GoalLayers::getInstance(unsigned int phase, unsigned int depth)
+	{
+		static std::mutex mutex;
+		static std::map<std::pair<unsigned int, unsigned int>, std::unique_ptr<GoalLayers>> instances;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::unique_ptr<GoalLayers> &instance = instances[{phase, depth}];
+		if (!instance)
+			instance.reset(new GoalLayers(phase, depth));
+
+		return *instance;
+	}
+
+	const std::vector<CoordinateNode> &GoalLayers::frontier() const
+	{
+		return _frontier;
+	}
+
+	/**
+	 * @return number of states of the table
+	 */
+	size_t GoalLayers::size() const
+	{
+		return _size;
+	}
+
+	size_t GoalLayers::bytes() const
+	{
+		return _file.size();
+	}
+}
@@ -0,0 +1,320 @@
+#include "cube/kociemba.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace rubik
+{
+	/**
+	 * Breadth-first search of the product of two coordinates from the solved state.
+	 * @param first - coordinate used as the major index
+	 * @param second - coordinate used as the minor index
+	 * @param legalMoves - moves allowed in the phase
+	 */
+	static std::vector<uint8_t> buildPruningTable(Coordinate first, Coordinate second, unsigned int legalMoves)
+	{
+		const MoveTables &moveTables = MoveTables::getInstance();
+		const unsigned int secondSize = COORDINATE_SIZES[second];
+
+		CubeState solved;
+		uint32_t start = computeCoordinate(first, solved) * secondSize + computeCoordinate(second, solved);
+
+		std::vector<uint8_t> table(COORDINATE_SIZES[first] * secondSize, UNREACHED_DEPTH);
+		std::vector<uint32_t> frontier(1, start);
+		std::vector<uint32_t> next;
+		table[start] = 0;
+
+		for (uint8_t depth = 0; !frontier.empty(); depth++)
+		{
+			next.clear();
+
+			for (uint32_t index : frontier)
+			{
+				uint16_t a = index / secondSize;
+				uint16_t b = index % secondSize;
+
+				for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES; m++)
+				{
+					if (legalMoves & (1 << m))
+					{
+						uint32_t child = moveTables.apply(first, a, Move(m)) * secondSize +
+										 moveTables.apply(second, b, Move(m));
+
+						if (table[child] == UNREACHED_DEPTH)
+						{
+							table[child] = depth + 1;
+							next.push_back(child);
+						}
+					}
+				}
+			}
+
+			std::swap(frontier, next);
+		}
+
+		return table;
+	}
+
+	/**
+	 * Map a pruning table from its file or build it.
+	 */
+	static MappedTable loadPruningTable(Coordinate first, Coordinate second, unsigned int legalMoves)
+	{
+		std::string name = std::string("prune_") + COORDINATE_NAMES[first] + "_" + COORDINATE_NAMES[second];
+
+		return loadOrBuildTable(name, COORDINATE_SIZES[first] * COORDINATE_SIZES[second], [=]()
+								{ return buildPruningTable(first, second, legalMoves); });
+	}
+
+	KociembaTables::KociembaTables()
+	{
+		MoveTables::getInstance();
+
+		_files[0] = loadPruningTable(CORNER_TWIST, SLICE_COMBINATION, KOCIEMBA_MOVES[0]);
+		_files[1] = loadPruningTable(EDGE_FLIP, SLICE_COMBINATION, KOCIEMBA_MOVES[0]);
+		_files[2] = loadPruningTable(CORNER_PERMUTATION, SLICE_PERMUTATION, KOCIEMBA_MOVES[1]);
+		_files[3] = loadPruningTable(EDGE_PERMUTATION, SLICE_PERMUTATION, KOCIEMBA_MOVES[1]);
+
+		_twistSlice = _files[0].data();
+		_flipSlice = _files[1].data();
+		_cornerSlice = _files[2].data();
+		_edgeSlice = _files[3].data();
+	}
+
+	/**
+	 * Access the tables, building them on the first call.
+	 */
+	const KociembaTables &KociembaTables::getInstance()
+	{
+		static const KociembaTables instance;
+		return instance;
+	}
+
+	/**
+	 * Depth-first searches with iterative deepening of both phases.
+	 */
+	class TwoPhaseSearch
+	{
+		const MoveTables &_moves;
+		const KociembaTables &_tables;
+		const SearchLimits &_limits;
+		CubeState _problem;
+		unsigned int _maxLength;
+
+		Move _path[KOCIEMBA_MAX_PHASE1_LENGTH + KOCIEMBA_MAX_PHASE2_LENGTH];
+
+		// Length of the phase 1 part of the last path found
+		unsigned int _phase1Length;
+		uint64_t _phase1Nodes;
+		uint64_t _phase2Nodes;
+		double _phase2Seconds;
+		// Set once the limits were reached, every search then returns at once
+		bool _stopped;
+
+	public:
+		TwoPhaseSearch(const CubeState &problem, unsigned int maxLength, const SearchLimits &limits)
+			: _moves(MoveTables::getInstance()), _tables(KociembaTables::getInstance()), _limits(limits),
+			  _problem(problem), _maxLength(maxLength), _phase1Length(0),
+			  _phase1Nodes(0), _phase2Nodes(0), _phase2Seconds(0.0), _stopped(false) {}
+
+		unsigned int phase1Length() const
+		{
+			return _phase1Length;
+		}
+
+		uint64_t phase1Nodes() const
+		{
+			return _phase1Nodes;
+		}
+
+		uint64_t phase2Nodes() const
+		{
+			return _phase2Nodes;
+		}
+
+		double phase2Seconds() const
+		{
+			return _phase2Seconds;
+		}
+
+		bool stopped() const
+		{
+			return _stopped;
+		}
+
+		/**
+		 * Find a solution of at most maxLength moves. Phase 1 solutions are tried
+		 * in increasing length, each one followed by the shortest phase 2 that fits.
+		 */
+		std::vector<Move> solve()
+		{
+			uint16_t twist = cornerTwist(_problem);
+			uint16_t flip = edgeFlip(_problem);
+			uint16_t slice = sliceCombination(_problem);
+
+			for (_phase1Length = 0; _phase1Length <= std::min(_maxLength, KOCIEMBA_MAX_PHASE1_LENGTH); _phase1Length++)
+			{
+				unsigned int length = 0;
+				if (phase1(twist, flip, slice, 0, _phase1Length, -1, length))
+				{
+					return std::vector<Move>(_path, _path + length);
+				}
+			}
+
+			return std::vector<Move>();
+		}
+
+	private:
+		/**
+		 * Check the limits every few thousand nodes of a phase.
+		 * @param count - nodes of the phase before this one
+		 * @return if the search must stop
+		 */
+		bool checkLimits(uint64_t count)
+		{
+			if (!_stopped && (count & 0xFFF) == 0)
+				_stopped = _limits.reached(_phase1Nodes + _phase2Nodes);
+
+			return _stopped;
+		}
+
+		bool phase1(uint16_t twist, uint16_t flip, uint16_t slice,
+					unsigned int depth, unsigned int togo, int lastFace, unsigned int &length)
+		{
+			if (checkLimits(_phase1Nodes++))
+				return false;
+
+			uint8_t estimate = std::max(_tables.twistSlice(twist, slice), _tables.flipSlice(flip, slice));
+
+			if (estimate > togo)
+				return false;
+
+			if (togo == 0)
+				return startPhase2(depth, lastFace, length);
+
+			const MoveList &moves = CANONICAL_MOVE_LISTS<KOCIEMBA_MOVES[0]>[lastFace + 1];
+
+			for (uint8_t i = 0; i < moves.size; i++)
+			{
+				Move move(moves.moves[i]);
+				_path[depth] = move;
+
+				if (phase1(_moves.apply(CORNER_TWIST, twist, move),
+						   _moves.apply(EDGE_FLIP, flip, move),
+						   _moves.apply(SLICE_COMBINATION, slice, move),
+						   depth + 1, togo - 1, move.getFace(), length))
+					return true;
+			}
+
+			return false;
+		}
+
+		bool startPhase2(unsigned int depth, int lastFace, unsigned int &length)
+		{
+			auto start = std::chrono::steady_clock::now();
+			bool found = false;
+
+			CubeState state = _problem;
+			for (unsigned int i = 0; i < depth; i++)
+				state.applyMoveInPlace(_path[i]);
+
+			uint16_t corners = cornerPermutation(state);
+			uint16_t edges = edgePermutation(state);
+			uint16_t slice = slicePermutation(state);
+
+			unsigned int maxPhase2 = std::min(_maxLength - depth, KOCIEMBA_MAX_PHASE2_LENGTH);
+
+			for (unsigned int togo = 0; togo <= maxPhase2 && !found; togo++)
+			{
+				found = phase2(corners, edges, slice, depth, togo, lastFace, length);
+			}
+
+			std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+			_phase2Seconds += duration.count();
+
+			return found;
+		}
+
+		bool phase2(uint16_t corners, uint16_t edges, uint16_t slice,
+					unsigned int depth, unsigned int togo, int lastFace, unsigned int &length)
+		{
+			if (checkLimits(_phase2Nodes++))
+				return false;
+
+			uint8_t estimate = std::max(_tables.cornerSlice(corners, slice), _tables.edgeSlice(edges, slice));
+
+			if (estimate > togo)
+				return false;
+
+			if (togo == 0)
+			{
+				length = depth;
+				return true;
+			}
+
+			const MoveList &moves = CANONICAL_MOVE_LISTS<KOCIEMBA_MOVES[1]>[lastFace + 1];
+
+			for (uint8_t i = 0; i < moves.size; i++)
+			{
+				Move move(moves.moves[i]);
+				_path[depth] = move;
+
+				if (phase2(_moves.apply(CORNER_PERMUTATION, corners, move),
+						   _moves.apply(EDGE_PERMUTATION, edges, move),
+						   _moves.apply(SLICE_PERMUTATION, slice, move),
+						   depth + 1, togo - 1, move.getFace(), length))
+					return true;
+			}
+
+			return false;
+		}
+	};
+
+	/**
+	 * Compute an algorithm to solve the current scrambled state of the cube with
+	 * Kociemba's two-phase algorithm, using IDA* over pruning tables in both phases.
+	 * The orientation of the centers is not considered.
+	 * @param problem - state of the cube to solve
+	 * @param maxLength - longest solution accepted, 30 or more always succeeds quickly
+	 * @param report - filled with the time, nodes and moves of each phase if given
+	 * @param limits - stop request, deadline and budget of nodes of both phases
+	 */
+	std::queue<Move> kociemba(CubeState problem, unsigned int maxLength, SolveReport *report,
+							  const SearchLimits &limits)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		TwoPhaseSearch search(problem, maxLength, limits);
+		std::vector<Move> algorithm = search.solve();
+		std::queue<Move> solution = optimizeSolution(algorithm);
+
+		if (report != nullptr)
+		{
+			std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+			// Only the junction of both phases can be simplified, it is counted in the second one
+			unsigned int phase1Moves = std::min<size_t>(search.phase1Length(), algorithm.size());
+
+			// Every length of phase 1 was tried without success
+			bool exhausted = search.phase1Length() > std::min(maxLength, KOCIEMBA_MAX_PHASE1_LENGTH);
+
+			report->status = SolveStatus::SOLVED;
+			if (search.stopped())
+				report->status = stoppedStatus(limits, search.phase1Nodes() + search.phase2Nodes());
+			else if (exhausted)
+				report->status = SolveStatus::NOT_FOUND;
+
+			report->seconds = duration.count();
+			report->phases = {PhaseReport{duration.count() - search.phase2Seconds(), search.phase1Nodes(),
+										  phase1Moves, phase1Moves},
+							  PhaseReport{search.phase2Seconds(), search.phase2Nodes(),
+										  unsigned(algorithm.size() - phase1Moves),
+										  unsigned(solution.size() - std::min<size_t>(phase1Moves, solution.size()))}};
+			report->peakVisited = 0;
+			report->scratchGrowthBytes = 0;
+			report->scratchBytes = 0;
+		}
+
+		return solution;
+	}
+}
@@ -0,0 +1,416 @@
+#include "cube/korf.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "cube/parallelida.h"
+#include "cube/permutation.h"
+#include "cube/threadpool.h"
+
+namespace rubik
+{
+	/*
+	Where each move sends the edge at a position and how it flips it, the
+	inverse view of MovePermutation that the edge placements need.
+	*/
+	struct EdgeMove
+	{
+		uint8_t destination[NUM_EDGES];
+		uint8_t flip[NUM_EDGES];
+	};
+
+	constexpr std::array<EdgeMove, NUM_POSSIBLE_MOVES> EDGE_MOVES = []()
+	{
+		std::array<EdgeMove, NUM_POSSIBLE_MOVES> moves{};
+
+		for (unsigned int m = 0; m < NUM_POSSIBLE_MOVES; m++)
+		{
+			for (unsigned int i = 0; i < NUM_EDGES; i++)
+			{
+				moves[m].destination[MOVE_PERMUTATIONS[m].source[i]] = i;
+				moves[m].flip[MOVE_PERMUTATIONS[m].source[i]] = MOVE_PERMUTATIONS[m].orientation[i];
+			}
+		}
+
+		return moves;
+	}();
+
+	// Depth of the prefixes the parallel search splits every iteration into
+	const static unsigned int KORF_SPLIT_DEPTH = 3;
+
+	/**
+	 * Position and flip of every edge cubie of a state.
+	 */
+	EdgePlacement edgePlacement(const CubeState &state)
+	{
+		const uint8_t *data = state.data();
+		EdgePlacement placement;
+
+		for (unsigned int e = 0; e < NUM_EDGES; e++)
+		{
+			placement.position[data[e]] = e;
+			placement.flip[data[e]] = data[TOTAL_NUM_CUBIES + e];
+		}
+
+		return placement;
+	}
+
+	/**
+	 * Index of 6 edges in an edge pattern database: rank of their positions among the
+	 * 12! / 6! ordered choices, then their flips in the 6 low bits.
+	 * @param position - positions of the 6 edges
+	 * @param flip - flips of the 6 edges
+	 */
+	uint32_t edgePatternIndex(const uint8_t *position, const uint8_t *flip)
+	{
+		uint32_t used = 0, rank = 0, flips = 0;
+
+		for (unsigned int k = 0; k < EDGE_PATTERN_CUBIES; k++)
+		{
+			// Positions left are renumbered without the ones already taken
+			rank = rank * (NUM_EDGES - k) + position[k] - bitCount(used & ((1u << position[k]) - 1));
+			used |= 1u << position[k];
+			flips = (flips << 1) | flip[k];
+		}
+
+		return (rank << EDGE_PATTERN_CUBIES) | flips;
+	}
+
+	/**
+	 * Positions and flips of the 6 edges of an edge pattern database index.
+	 */
+	static void edgePatternUnrank(uint32_t index, uint8_t *position, uint8_t *flip)
+	{
+		uint32_t rank = index >> EDGE_PATTERN_CUBIES;
+		uint8_t digits[EDGE_PATTERN_CUBIES];
+
+		for (unsigned int k = EDGE_PATTERN_CUBIES; k-- > 0;)
+		{
+			digits[k] = rank % (NUM_EDGES - k);
+			rank /= NUM_EDGES - k;
+			flip[k] = (index >> (EDGE_PATTERN_CUBIES - 1 - k)) & 0b1;
+		}
+
+		uint32_t used = 0;
+		for (unsigned int k = 0; k < EDGE_PATTERN_CUBIES; k++)
+		{
+			// Position of the digits[k]-th free position
+			unsigned int p = 0;
+			for (unsigned int free = 0;; p++)
+			{
+				if (!(used & (1u << p)) && free++ == digits[k])
+					break;
+			}
+
+			position[k] = p;
+			used |= 1u << p;
+		}
+	}
+
+	/**
+	 * Breadth-first search of a pattern from the solved state, in place in the table.
+	 * Each pass scans the table for the entries of the current depth and marks their
+	 * unreached neighbours. Once fewer entries are left unreached than the last depth
+	 * holds, the passes scan the unreached entries instead and look for a neighbour of
+	 * the current depth, which touches far fewer entries at the end of the search.
+	 * @param size - number of entries
+	 * @param start - index of the solved state
+	 * @param neighbours - fills the 18 indexes one move away from an index
+	 */
+	template <typename Neighbours>
+	static std::vector<uint8_t> buildPatternDatabase(uint32_t size, uint32_t start, const Neighbours &neighbours)
+	{
+		std::vector<uint8_t> table((size + 1) / 2, 0xFF);
+		uint32_t next[NUM_POSSIBLE_MOVES];
+
+		auto set = [&](uint32_t index, uint8_t depth)
+		{
+			uint8_t shift = (index & 1) * 4;
+			table[index >> 1] = (table[index >> 1] & ~(0xF << shift)) | (depth << shift);
+		};
+
+		set(start, 0);
+		uint64_t reached = 1, layer = 1;
+
+		for (uint8_t depth = 0; reached < size && layer > 0; depth++)
+		{
+			bool backward = size - reached < layer;
+			layer = 0;
+
+			for (uint32_t index = 0; index < size; index++)
+			{
+				uint8_t value = PatternDatabases::entry(table.data(), index);
+
+				if (!backward && value == depth)
+				{
+					neighbours(index, next);
+					for (uint32_t child : next)
+					{
+						if (PatternDatabases::entry(table.data(), child) == UNREACHED_PATTERN)
+						{
+							set(child, depth + 1);
+							layer++;
+						}
+					}
+				}
+				else if (backward && value == UNREACHED_PATTERN)
+				{
+					neighbours(index, next);
+					for (uint32_t parent : next)
+					{
+						if (PatternDatabases::entry(table.data(), parent) == depth)
+						{
+							set(index, depth + 1);
+							layer++;
+							break;
+						}
+					}
+				}
+			}
+
+			reached += layer;
+		}
+
+		return table;
+	}
+
+	static std::vector<uint8_t> buildCornerPattern()
+	{
+		const MoveTables &moveTables = MoveTables::getInstance();
+		const uint32_t twists = COORDINATE_SIZES[CORNER_TWIST];
+
+		CubeState solved;
+		uint32_t start = cornerPermutation(solved) * twists + cornerTwist(solved);
+
+		return buildPatternDatabase(CORNER_PATTERN_SIZE, start, [&](uint32_t index, uint32_t *next)
+									{
+			uint16_t permutation = index / twists;
+			uint16_t twist = index % twists;
+
+			for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES; m++)
+				next[m] = moveTables.apply(CORNER_PERMUTATION, permutation, Move(m)) * twists +
+						  moveTables.apply(CORNER_TWIST, twist, Move(m)); });
+	}
+
+	/**
+	 * @param first - first edge cubie of the pattern
+	 */
+	static std::vector<uint8_t> buildEdgePattern(unsigned int first)
+	{
+		EdgePlacement solved = edgePlacement(CubeState());
+		uint32_t start = edgePatternIndex(solved.position + first, solved.flip + first);
+
+		return buildPatternDatabase(EDGE_PATTERN_SIZE, start, [](uint32_t index, uint32_t *next)
+									{
+			uint8_t position[EDGE_PATTERN_CUBIES], flip[EDGE_PATTERN_CUBIES];
+			edgePatternUnrank(index, position, flip);
+
+			for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES; m++)
+			{
+				uint8_t movedPosition[EDGE_PATTERN_CUBIES], movedFlip[EDGE_PATTERN_CUBIES];
+				for (unsigned int k = 0; k < EDGE_PATTERN_CUBIES; k++)
+				{
+					movedPosition[k] = EDGE_MOVES[m].destination[position[k]];
+					movedFlip[k] = flip[k] ^ EDGE_MOVES[m].flip[position[k]];
+				}
+
+				next[m] = edgePatternIndex(movedPosition, movedFlip);
+			} });
+	}
+
+	PatternDatabases::PatternDatabases()
+	{
+		MoveTables::getInstance();
+
+		_files[0] = loadOrBuildTable("pattern_corners", (CORNER_PATTERN_SIZE + 1) / 2, buildCornerPattern);
+		_files[1] = loadOrBuildTable("pattern_edges_0", (EDGE_PATTERN_SIZE + 1) / 2, []()
+									 { return buildEdgePattern(0); });
+		_files[2] = loadOrBuildTable("pattern_edges_1", (EDGE_PATTERN_SIZE + 1) / 2, []()
+									 { return buildEdgePattern(EDGE_PATTERN_CUBIES); });
+
+		_corners = _files[0].data();
+		_edges[0] = _files[1].data();
+		_edges[1] = _files[2].data();
+	}
+
+	/**
+	 * Access the databases, building them on the first call.
+	 */
+	const PatternDatabases &PatternDatabases::getInstance()
+	{
+		static const PatternDatabases instance;
+		return instance;
+	}
+
+	/**
+	 * Corners and edges of a state as the pattern databases index them.
+	 */
+	struct KorfNode
+	{
+		uint16_t corners;
+		uint16_t twist;
+		EdgePlacement edges;
+	};
+
+	/**
+	 * IDA* over the pattern databases, the first iteration that reaches the solved state
+	 * gives a shortest solution.
+	 */
+	class OptimalSearch : public ParallelIdaSearch<OptimalSearch, KorfNode, KORF_SPLIT_DEPTH>
+	{
+		friend class ParallelIdaSearch<OptimalSearch, KorfNode, KORF_SPLIT_DEPTH>;
+
+		const MoveTables &_moves;
+		const PatternDatabases &_tables;
+		KorfNode _root;
+
+		std::mutex _mutex;
+		std::vector<Move> _solution;
+		bool _found;
+
+	public:
+		OptimalSearch(const CubeState &problem, const SearchLimits &limits)
+			: ParallelIdaSearch(limits), _moves(MoveTables::getInstance()), _tables(PatternDatabases::getInstance()),
+			  _found(false)
+		{
+			_root.corners = cornerPermutation(problem);
+			_root.twist = cornerTwist(problem);
+			_root.edges = edgePlacement(problem);
+		}
+
+		const std::vector<Move> &solution() const
+		{
+			return _solution;
+		}
+
+		bool found() const
+		{
+			return _found;
+		}
+
+		/**
+		 * Run the iterations with increasing bounds until one finds a solution.
+		 * @param pool - threads sharing the subtrees of every iteration
+		 */
+		void solve(ThreadPool &pool)
+		{
+			iterate(pool, _root, estimate(_root, KORF_MAX_LENGTH), [&](unsigned int threshold)
+					{ return !_found && threshold <= KORF_MAX_LENGTH; });
+		}
+
+	private:
+		KorfNode child(const KorfNode &node, const Move &move) const
+		{
+			KorfNode child;
+			child.corners = _moves.apply(CORNER_PERMUTATION, node.corners, move);
+			child.twist = _moves.apply(CORNER_TWIST, node.twist, move);
+
+			const EdgeMove &edgeMove = EDGE_MOVES[move.code()];
+			for (unsigned int e = 0; e < NUM_EDGES; e++)
+			{
+				child.edges.position[e] = edgeMove.destination[node.edges.position[e]];
+				child.edges.flip[e] = node.edges.flip[e] ^ edgeMove.flip[node.edges.position[e]];
+			}
+
+			return child;
+		}
+
+		/**
+		 * Largest of the three database entries, looked up from the corners, which prune
+		 * the most, and only as far as needed to exceed the bound.
+		 * @param togo - moves left to the bound of the iteration
+		 */
+		uint8_t estimate(const KorfNode &node, unsigned int togo) const
+		{
+			uint8_t corners = _tables.corners(uint32_t(node.corners) * COORDINATE_SIZES[CORNER_TWIST] + node.twist);
+			if (corners > togo)
+				return corners;
+
+			uint8_t first = _tables.edges(0, edgePatternIndex(node.edges.position, node.edges.flip));
+			if (first > togo)
+				return first;
+
+			uint8_t second = _tables.edges(1, edgePatternIndex(node.edges.position + EDGE_PATTERN_CUBIES,
+															   node.edges.flip + EDGE_PATTERN_CUBIES));
+
+			return std::max({corners, first, second});
+		}
+
+		bool prune(const KorfNode &node, unsigned int togo) const
+		{
+			return estimate(node, togo) > togo;
+		}
+
+		/**
+		 * Every database is at 0 only on the solved state, the first path found is kept.
+		 */
+		bool reached(const KorfNode &, const Move *path, unsigned int length, unsigned int)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_found)
+			{
+				_solution.assign(path, path + length);
+				_found = true;
+			}
+
+			return true;
+		}
+	};
+
+	/**
+	 * Compute a shortest algorithm to solve the current scrambled state of the cube with
+	 * Korf's algorithm: IDA* with the largest entry of the corner and edge pattern
+	 * databases as the heuristic. The orientation of the centers is not considered.
+	 * @param problem - state of the cube to solve
+	 * @param pool - workers sharing the subtrees of each iteration
+	 * @param report - filled with the time to the optimal solution and the nodes if given
+	 * @param limits - stop request, deadline and budget of nodes
+	 */
+	std::queue<Move> korf(CubeState problem, ThreadPool &pool, SolveReport *report, const SearchLimits &limits)
+	{
+		// Loaded before the clock starts, the report only measures the search
+		PatternDatabases::getInstance();
+
+		auto start = std::chrono::steady_clock::now();
+
+		OptimalSearch search(problem, limits);
+		search.solve(pool);
+
+		std::queue<Move> solution;
+		for (const Move &move : search.solution())
+			solution.push(move);
+
+		if (report != nullptr)
+		{
+			std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+			report->status = SolveStatus::SOLVED;
+			if (search.stopped() && !search.found())
+				report->status = stoppedStatus(limits, search.nodes());
+			else if (!search.found())
+				report->status = SolveStatus::NOT_FOUND;
+
+			report->seconds = duration.count();
+			report->phases = {PhaseReport{duration.count(), search.nodes(), unsigned(search.solution().size()),
+										  unsigned(search.solution().size())}};
+			report->peakVisited = 0;
+			report->scratchGrowthBytes = 0;
+			report->scratchBytes = 0;
+		}
+
+		return solution;
+	}
+
+	/**
+	 * Compute a shortest algorithm on a temporary pool.
+	 * @param threads - number of threads, 0 for one per hardware thread
+	 */
+	std::queue<Move> korf(CubeState problem, unsigned int threads, SolveReport *report, const SearchLimits &limits)
+	{
+		ThreadPool pool(threads);
+		return korf(problem, pool, report, limits);
+	}
+}
@@ -54,68 +54,6 @@ namespace rubik
         return MoveAxis(getFace() / 2);
     }
 
-    /**
-     * Get the rotation modification of the model.
-     * @return the axis to turn around and the angle to turn by
-     */
-    glm::vec4 Move::toAxisAngle() const
-    {
-        glm::vec3 axis(0, 0, 0);
-
-        int face = getFace();
-        int turns = getTurns();
-
-        switch (face)
-        {
-        case 0:
-            axis[1] = 1;
-            break;
-        case 1:
-            axis[1] = -1;
-            break;
-        case 2:
-            axis[2] = 1;
-            break;
-        case 3:
-            axis[2] = -1;
-            break;
-        case 4:
-            axis[0] = -1;
-            break;
-        case 5:
-            axis[0] = 1;
-            break;
-        }
-
-        float angle = (turns - (4 * (turns == 3))) * M_PI / 2.0f;
-
-        return glm::vec4(axis, -angle);
-    }
-
-    /**
-     * @param normals - normals of the sides the cubie touches
-     * @return if the piece is part of the side that turns
-     */
-    bool Move::affectsPiece(const std::vector<glm::vec3> normals) const
-    {
-        int face = getFace();
-
-        for (int i = 0; i < normals.size(); i++)
-        {
-            glm::vec3 normal = normals[i];
-
-            if ((face == 0 && normal[1] > 0) ||
-                (face == 1 && normal[1] < 0) ||
-                (face == 2 && normal[2] > 0) ||
-                (face == 3 && normal[2] < 0) ||
-                (face == 4 && normal[0] < 0) ||
-                (face == 5 && normal[0] > 0))
-                return true;
-        }
-
-        return false;
-    }
-
     /**
      * Shows the move in the standard rubik's cube format.
      * @param s - stream to later print
@@ -137,7 +75,7 @@ namespace rubik
                         '2' * (turns == 2);
 
         s << faceName;
-        if (turns > 2)
+        if (turns >= 2)
         {
             s << turnName;
         }
@@ -0,0 +1,251 @@
+#include "cube/nearoptimal.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "cube/coordinates.h"
+#include "cube/kociemba.h"
+#include "cube/parallelida.h"
+#include "cube/threadpool.h"
+
+namespace rubik
+{
+	/**
+	 * Anytime search of the hybrid algorithm. The first phases are enumerated in increasing
+	 * length by IDA* over the pruning tables of the two-phase algorithm. Every worker
+	 * finishes the first phases it finds with the other phases of the hybrid and the
+	 * shortest total is kept.
+	 */
+	class NearOptimalSearch : public ParallelIdaSearch<NearOptimalSearch, TKMetrics, NEAR_OPTIMAL_SPLIT_DEPTH>
+	{
+		friend class ParallelIdaSearch<NearOptimalSearch, TKMetrics, NEAR_OPTIMAL_SPLIT_DEPTH>;
+
+		const MoveTables &_moves;
+		const KociembaTables &_tables;
+		const SearchLimits &_limits;
+		CubeState _problem;
+		TKMetrics _root;
+		TKMetrics _goal;
+
+		// Options of the hybrid solves finishing the first phases
+		SolverOptions _phaseOptions;
+		SolutionCallback _onImprovement;
+		std::vector<SearchScratch> _scratches;
+
+		std::mutex _mutex;
+		std::vector<Move> _solution;
+		bool _found;
+
+	public:
+		NearOptimalSearch(const CubeState &problem, const SolverOptions &options, const SearchLimits &limits,
+						  unsigned int workers)
+			: ParallelIdaSearch(limits), _moves(MoveTables::getInstance()), _tables(KociembaTables::getInstance()),
+			  _limits(limits), _problem(problem), _root(problem.phaseMetrics<0>()),
+			  _goal(CubeState().phaseMetrics<0>()), _phaseOptions(options), _onImprovement(options.onImprovement),
+			  _scratches(workers), _found(false)
+		{
+			_phaseOptions.engine = SolverEngine::THISTLETHWAITE_KOCIEMBA;
+			_phaseOptions.searchThreads = 1;
+			_phaseOptions.cache = nullptr;
+			_phaseOptions.onImprovement = nullptr;
+		}
+
+		const std::vector<Move> &solution() const
+		{
+			return _solution;
+		}
+
+		bool found() const
+		{
+			return _found;
+		}
+
+		size_t scratchBytes() const
+		{
+			size_t bytes = 0;
+			for (const SearchScratch &scratch : _scratches)
+				bytes += scratch.bytes();
+
+			return bytes;
+		}
+
+		/**
+		 * Solve once with the hybrid, then try the first phases of every length shorter
+		 * than the best solution until the limits are reached.
+		 * @param pool - threads sharing the first phases of every length
+		 */
+		void solve(ThreadPool &pool)
+		{
+			finish(nullptr, 0, 0, true);
+
+			iterate(pool, _root, estimate(_root), [&](unsigned int threshold)
+					{ return _found && threshold < _solution.size(); });
+		}
+
+	private:
+		/**
+		 * Lower bound of the first phase: the entries of both pruning tables, and the
+		 * side centers left with an odd orientation since a move only turns one of them.
+		 */
+		uint8_t estimate(const TKMetrics &node) const
+		{
+			return std::max({_tables.twistSlice(node.m1, node.m2), _tables.flipSlice(node.m3, node.m2),
+							 uint8_t(std::popcount(unsigned(node.m4 ^ _goal.m4)))});
+		}
+
+		/**
+		 * A first phase ending with a move that stays in the goal is a shorter one followed
+		 * by a move of the next phase, the shorter one was already tried.
+		 * @param togo - moves left to the bound once at the node
+		 */
+		bool redundant(const TKMetrics &node, unsigned int togo) const
+		{
+			return togo == 1 && node == _goal;
+		}
+
+		TKMetrics child(const TKMetrics &node, const Move &move) const
+		{
+			return _moves.updateMetrics<0>(node, move);
+		}
+
+		bool prune(const TKMetrics &node, unsigned int togo) const
+		{
+			return estimate(node) > togo || redundant(node, togo);
+		}
+
+		/**
+		 * Finish the first phases that reach the goal of the phase with the other phases.
+		 */
+		bool reached(const TKMetrics &node, const Move *path, unsigned int length, unsigned int worker)
+		{
+			return node == _goal && finish(path, length, worker, false);
+		}
+
+		/**
+		 * Solve the other phases after a first phase and keep the total if it is shorter.
+		 * @param path - moves of the first phase
+		 * @param length - number of moves of the first phase
+		 * @param worker - worker running the hybrid, owner of the search memory
+		 * @param seed - solve the problem as the hybrid would, the first phase included
+		 * @return if the other first phases of this length cannot give a shorter total
+		 */
+		bool finish(const Move *path, unsigned int length, unsigned int worker, bool seed)
+		{
+			CubeState state = _problem;
+			for (unsigned int i = 0; i < length; i++)
+				state.applyMoveInPlace(path[i]);
+
+			// The budget of states is shared by all the solves
+			SearchLimits limits = _limits;
+			if (_limits.maxNodes != 0)
+				limits.maxNodes = _limits.maxNodes > _nodes ? _limits.maxNodes - _nodes : 1;
+
+			SolveReport report;
+			std::queue<Move> phases =
+				thistlethwaiteKociemba(state, _phaseOptions, nullptr, &report, &_scratches[worker], limits);
+
+			for (const PhaseReport &phase : report.phases)
+				_nodes += phase.nodes;
+
+			std::vector<Move> algorithm(path, path + length);
+			while (!phases.empty())
+			{
+				algorithm.push_back(phases.front());
+				phases.pop();
+			}
+
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			if (report.status != SolveStatus::SOLVED)
+			{
+				// Without a complete solution, the seed still reaches the goal of its last phase
+				if (seed)
+					_solution = algorithm;
+
+				stop();
+				return true;
+			}
+
+			std::queue<Move> optimized = optimizeSolution(algorithm);
+			if (_found && optimized.size() >= _solution.size())
+				return false;
+
+			_solution.clear();
+			while (!optimized.empty())
+			{
+				_solution.push_back(optimized.front());
+				optimized.pop();
+			}
+
+			_found = true;
+
+			if (_onImprovement)
+				_onImprovement(_solution);
+
+			return !seed && _solution.size() <= length;
+		}
+	};
+
+	/**
+	 * Compute a short algorithm to solve the current scrambled state of the cube, as short
+	 * as the time allows. The hybrid keeps the first phase it finds, while a longer first
+	 * phase often leaves a much shorter rest: the first phases are tried in increasing
+	 * length, each one finished by the other phases of the hybrid, until the deadline.
+	 * @param problem - state of the cube to solve
+	 * @param options - parameters of the hybrid phases and the improvement callback
+	 * @param pool - workers sharing the first phases of every length
+	 * @param report - filled with the time and nodes of the whole search if given
+	 * @param limits - stop request, deadline and budget of nodes, reaching the deadline is the normal end
+	 */
+	std::queue<Move> nearOptimal(CubeState problem, const SolverOptions &options, ThreadPool &pool,
+								 SolveReport *report, const SearchLimits &limits)
+	{
+		// Loaded before the clock starts, the report only measures the search
+		KociembaTables::getInstance();
+
+		auto start = std::chrono::steady_clock::now();
+
+		NearOptimalSearch search(problem, options, limits, pool.size());
+		search.solve(pool);
+
+		std::queue<Move> solution;
+		for (const Move &move : search.solution())
+			solution.push(move);
+
+		if (report != nullptr)
+		{
+			std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+			report->status = SolveStatus::SOLVED;
+			if (search.stopped())
+				report->status = stoppedStatus(limits, search.nodes());
+
+			// The solution only improves until the deadline
+			if (search.found() && report->status == SolveStatus::TIMED_OUT)
+				report->status = SolveStatus::SOLVED;
+
+			report->seconds = duration.count();
+			report->phases = {PhaseReport{duration.count(), search.nodes(), unsigned(search.solution().size()),
+										  unsigned(search.solution().size())}};
+			// The scratches of the workers only live for this solve
+			report->peakVisited = 0;
+			report->scratchBytes = search.scratchBytes();
+			report->scratchGrowthBytes = report->scratchBytes;
+		}
+
+		return solution;
+	}
+
+	/**
+	 * Compute a short algorithm on a temporary pool of options.optimalThreads threads.
+	 */
+	std::queue<Move> nearOptimal(CubeState problem, const SolverOptions &options, SolveReport *report,
+								 const SearchLimits &limits)
+	{
+		ThreadPool pool(options.optimalThreads);
+		return nearOptimal(problem, options, pool, report, limits);
+	}
+}
@@ -0,0 +1,688 @@
+#include "cube/phasesearch.h"
+#include "cube/coordinates.h"
+#include "cube/goallayers.h"
+#include "cube/stateblock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+
+namespace rubik
+{
+	// Number of expanded states between two checks of the limits
+	const static uint64_t LIMITS_CHECK_INTERVAL = 256;
+
+	/**
+	 * Pool of the parallel search, created on first use and kept with the scratch.
+	 * @param threads - number of threads expanding a frontier
+	 */
+	ThreadPool &SearchScratch::getPool(unsigned int threads)
+	{
+		if (!pool || pool->size() != ThreadPool::workerCount(threads))
+			pool = std::make_unique<ThreadPool>(threads);
+
+		return *pool;
+	}
+
+	/**
+	 * @return bytes held by the tables and frontiers of the searches
+	 */
+	size_t SearchScratch::bytes() const
+	{
+		size_t total = visited.bytes() + sharedVisited.bytes() + queue.capacity() * sizeof(CubeState);
+
+		for (const std::vector<FrontierNode> &frontier : frontiers)
+			total += frontier.capacity() * sizeof(FrontierNode);
+		for (const std::vector<FrontierNode> &buffer : children)
+			total += buffer.capacity() * sizeof(FrontierNode);
+		for (const std::vector<CoordinateNode> &frontier : coordinateFrontiers)
+			total += frontier.capacity() * sizeof(CoordinateNode);
+		total += coordinateChildren.capacity() * sizeof(CoordinateNode);
+
+		return total;
+	}
+
+	/**
+	 * Connect a state to the goal of a phase with a bidirectional breadth-first search.
+	 * Both directions share a single queue and are interleaved node by node.
+	 * @param problem - state to start from
+	 * @tparam Phase - phase of the Thistlethwaite-Kociemba metrics
+	 * @tparam Canonical - only generate canonical sequences of moves (see canonicalMoves)
+	 * @param scratch - memory of the search
+	 * @param nodes - incremented by the number of generated states
+	 * @param limits - stop request, deadline and budget of generated states
+	 * @return algorithm reaching the goal of the phase, empty if the limits were reached
+	 */
+	template <unsigned int Phase, bool Canonical>
+	static std::vector<Move> interleavedSearch(const CubeState &problem, SearchScratch &scratch, uint64_t &nodes,
+											   const SearchLimits &limits)
+	{
+		CubeState goalState;
+
+		TKMetrics problemId = problem.phaseMetrics<Phase>(),
+				  goalId = goalState.phaseMetrics<Phase>();
+
+		VisitedTable &searchedSpace = scratch.visited;
+		searchedSpace.clear();
+
+		/* BFS QUEUE (read from the head, the memory is kept between phases) */
+		std::vector<CubeState> &q = scratch.queue;
+		size_t head = 0;
+		q.clear();
+		q.push_back(problem);
+		q.push_back(goalState);
+
+		/* BFS TABLES */
+		searchedSpace[problemId].directionMove |= 0x80;
+		searchedSpace[goalId].directionMove |= 0x40;
+
+		while (head < q.size())
+		{
+			if (head % LIMITS_CHECK_INTERVAL == 0 && limits.reached(nodes))
+				return std::vector<Move>();
+
+			// State to explore from
+			CubeState oldState = q[head++];
+
+			TKMetrics oldId = oldState.phaseMetrics<Phase>();
+			uint8_t oldDir = searchedSpace[oldId].directionMove;
+
+			int lastFace = oldId != problemId && oldId != goalId ? Move(oldDir & 0x3F).getFace() : -1;
+			const MoveList &legalMoves = PHASE_MOVE_LISTS<Phase, Canonical>[lastFace + 1];
+
+			// Explore all the legal moves for new states
+			for (uint8_t i = 0; i < legalMoves.size; i++)
+			{
+				Move move(legalMoves.moves[i]);
+
+				CubeState newState = oldState.applyMove(move);
+				nodes++;
+
+				TKMetrics newId = newState.phaseMetrics<Phase>();
+				TKInformation &newInformation = searchedSpace[newId];
+				uint8_t newDir = newInformation.directionMove;
+
+				// The new state has already been seen and it has a different direction.
+				// This means that the scrambled and solved states are now connected.
+				if ((newDir & 0xC0) != 0 && (newDir & 0xC0) != (oldDir & 0xC0))
+					return connectPaths(searchedSpace, oldId, newId, move, oldDir, problemId, goalId);
+
+				// State was never seen. Update the tables and set the direction.
+				if (!newDir)
+				{
+					q.push_back(newState);
+					newInformation.directionMove = ((oldDir & 0xC0) | (move.code() & 0x3F));
+					newInformation.pred = oldId;
+				}
+			}
+		}
+
+		return std::vector<Move>();
+	}
+
+	/**
+	 * Connect a state to the goal of a phase with a layered bidirectional search.
+	 * The forward and backward frontiers are kept apart and the smaller one is expanded
+	 * by a full layer at a time. Since the layers seen by both sides never intersected
+	 * before, the first meeting gives the shortest algorithm of the phase.
+	 * @param problem - state to start from
+	 * @tparam Phase - phase of the Thistlethwaite-Kociemba metrics
+	 * @tparam Canonical - only generate canonical sequences of moves (see canonicalMoves)
+	 * @param scratch - memory of the search
+	 * @param nodes - incremented by the number of generated states
+	 * @param limits - stop request, deadline and budget of generated states
+	 * @return algorithm reaching the goal of the phase, empty if the limits were reached
+	 */
+	template <unsigned int Phase, bool Canonical>
+	static std::vector<Move> layeredSearch(const CubeState &problem, SearchScratch &scratch, uint64_t &nodes,
+										   const SearchLimits &limits)
+	{
+		CubeState goalState;
+
+		TKMetrics problemId = problem.phaseMetrics<Phase>(),
+				  goalId = goalState.phaseMetrics<Phase>();
+
+		VisitedTable &searchedSpace = scratch.visited;
+		searchedSpace.clear();
+		searchedSpace[problemId].directionMove = 0x80;
+		searchedSpace[goalId].directionMove = 0x40;
+
+		std::vector<FrontierNode> &forward = scratch.frontiers[0], &backward = scratch.frontiers[1];
+		forward.assign(1, FrontierNode{problem, problemId, 0x80, -1});
+		backward.assign(1, FrontierNode{goalState, goalId, 0x40, -1});
+
+		scratch.children.resize(1);
+		std::vector<FrontierNode> &next = scratch.children[0];
+		uint64_t expanded = 0;
+
+		while (!forward.empty() && !backward.empty())
+		{
+			std::vector<FrontierNode> &layer = forward.size() <= backward.size() ? forward : backward;
+			next.clear();
+
+			for (const FrontierNode &node : layer)
+			{
+				if (expanded++ % LIMITS_CHECK_INTERVAL == 0 && limits.reached(nodes))
+					return std::vector<Move>();
+
+				const MoveList &legalMoves = PHASE_MOVE_LISTS<Phase, Canonical>[node.lastFace + 1];
+
+				for (uint8_t i = 0; i < legalMoves.size; i++)
+				{
+					Move move(legalMoves.moves[i]);
+
+					CubeState newState = node.state.applyMove(move);
+					nodes++;
+
+					TKMetrics newId = newState.phaseMetrics<Phase>();
+					TKInformation &newInformation = searchedSpace[newId];
+					uint8_t newDir = newInformation.directionMove;
+
+					if ((newDir & 0xC0) != 0 && (newDir & 0xC0) != (node.directionMove & 0xC0))
+						return connectPaths(searchedSpace, node.id, newId, move, node.directionMove, problemId, goalId);
+
+					if (!newDir)
+					{
+						newInformation.directionMove = ((node.directionMove & 0xC0) | (move.code() & 0x3F));
+						newInformation.pred = node.id;
+						next.push_back(FrontierNode{newState, newId, newInformation.directionMove, int8_t(move.getFace())});
+					}
+				}
+			}
+
+			layer.swap(next);
+		}
+
+		return std::vector<Move>();
+	}
+
+	/**
+	 * Same search as layeredSearch, but the layer is cut into blocks of STATE_BLOCK_SIZE states
+	 * that are turned and measured together by expandBlock, one move at a time.
+	 * Every lane of a block is computed, the moves a lane does not allow are dropped after.
+	 */
+	template <unsigned int Phase, bool Canonical>
+	static std::vector<Move> blockSearch(const CubeState &problem, SearchScratch &scratch, uint64_t &nodes,
+										 const SearchLimits &limits)
+	{
+		CubeState goalState;
+
+		TKMetrics problemId = problem.phaseMetrics<Phase>(),
+				  goalId = goalState.phaseMetrics<Phase>();
+
+		VisitedTable &searchedSpace = scratch.visited;
+		searchedSpace.clear();
+		searchedSpace[problemId].directionMove = 0x80;
+		searchedSpace[goalId].directionMove = 0x40;
+
+		std::vector<FrontierNode> &forward = scratch.frontiers[0], &backward = scratch.frontiers[1];
+		forward.assign(1, FrontierNode{problem, problemId, 0x80, -1});
+		backward.assign(1, FrontierNode{goalState, goalId, 0x40, -1});
+
+		scratch.children.resize(1);
+		std::vector<FrontierNode> &next = scratch.children[0];
+		uint64_t expanded = 0;
+
+		// The unused lanes keep valid states from the previous block
+		StateBlock parents{}, children;
+		MetricsBlock metrics;
+		const MoveList &phaseMoves = PHASE_MOVE_LISTS<Phase, false>[0];
+		unsigned int legal[STATE_BLOCK_SIZE];
+
+		while (!forward.empty() && !backward.empty())
+		{
+			std::vector<FrontierNode> &layer = forward.size() <= backward.size() ? forward : backward;
+			next.clear();
+
+			for (size_t first = 0; first < layer.size(); first += STATE_BLOCK_SIZE)
+			{
+				if (expanded % LIMITS_CHECK_INTERVAL < STATE_BLOCK_SIZE && limits.reached(nodes))
+					return std::vector<Move>();
+
+				const FrontierNode *nodesOfBlock = &layer[first];
+				parents.size = unsigned(std::min<size_t>(STATE_BLOCK_SIZE, layer.size() - first));
+				expanded += parents.size;
+
+				for (unsigned int k = 0; k < parents.size; k++)
+				{
+					parents.set(k, nodesOfBlock[k].state);
+					legal[k] = Canonical ? canonicalMoves(nodesOfBlock[k].lastFace) : ~0u;
+				}
+
+				for (uint8_t i = 0; i < phaseMoves.size; i++)
+				{
+					Move move(phaseMoves.moves[i]);
+					expandBlock(parents, move, Phase, children, metrics);
+
+					for (unsigned int k = 0; k < parents.size; k++)
+					{
+						if (!(legal[k] & (1 << move.code())))
+							continue;
+
+						const FrontierNode &node = nodesOfBlock[k];
+						nodes++;
+
+						TKMetrics newId = metrics.get(k);
+						TKInformation &newInformation = searchedSpace[newId];
+						uint8_t newDir = newInformation.directionMove;
+
+						if ((newDir & 0xC0) != 0 && (newDir & 0xC0) != (node.directionMove & 0xC0))
+							return connectPaths(searchedSpace, node.id, newId, move, node.directionMove, problemId, goalId);
+
+						if (!newDir)
+						{
+							newInformation.directionMove = ((node.directionMove & 0xC0) | (move.code() & 0x3F));
+							newInformation.pred = node.id;
+							next.push_back(FrontierNode{children.get(k), newId, newInformation.directionMove, int8_t(move.getFace())});
+						}
+					}
+				}
+			}
+
+			layer.swap(next);
+		}
+
+		return std::vector<Move>();
+	}
+
+	/**
+	 * Same search as layeredSearch, run on the metrics alone: the metrics of a child come
+	 * from those of its parent through MoveTables, so no cubie is turned nor scanned.
+	 */
+	template <unsigned int Phase, bool Canonical>
+	static std::vector<Move> coordinateSearch(const CubeState &problem, SearchScratch &scratch, uint64_t &nodes,
+											  const SearchLimits &limits)
+	{
+		const MoveTables &tables = MoveTables::getInstance();
+		CubeState goalState;
+
+		TKMetrics problemId = problem.phaseMetrics<Phase>(),
+				  goalId = goalState.phaseMetrics<Phase>();
+
+		VisitedTable &searchedSpace = scratch.visited;
+		searchedSpace.clear();
+		searchedSpace[problemId].directionMove = 0x80;
+		searchedSpace[goalId].directionMove = 0x40;
+
+		std::vector<CoordinateNode> &forward = scratch.coordinateFrontiers[0],
+									&backward = scratch.coordinateFrontiers[1];
+		forward.assign(1, CoordinateNode{problemId, 0x80, -1});
+		backward.assign(1, CoordinateNode{goalId, 0x40, -1});
+
+		std::vector<CoordinateNode> &next = scratch.coordinateChildren;
+		uint64_t expanded = 0;
+
+		while (!forward.empty() && !backward.empty())
+		{
+			std::vector<CoordinateNode> &layer = forward.size() <= backward.size() ? forward : backward;
+			next.clear();
+
+			for (const CoordinateNode &node : layer)
+			{
+				if (expanded++ % LIMITS_CHECK_INTERVAL == 0 && limits.reached(nodes))
+					return std::vector<Move>();
+
+				const MoveList &legalMoves = PHASE_MOVE_LISTS<Phase, Canonical>[node.lastFace + 1];
+
+				for (uint8_t i = 0; i < legalMoves.size; i++)
+				{
+					Move move(legalMoves.moves[i]);
+					nodes++;
+
+					TKMetrics newId = tables.updateMetrics<Phase>(node.id, move);
+					TKInformation &newInformation = searchedSpace[newId];
+					uint8_t newDir = newInformation.directionMove;
+
+					if ((newDir & 0xC0) != 0 && (newDir & 0xC0) != (node.directionMove & 0xC0))
+						return connectPaths(searchedSpace, node.id, newId, move, node.directionMove, problemId, goalId);
+
+					if (!newDir)
+					{
+						newInformation.directionMove = ((node.directionMove & 0xC0) | (move.code() & 0x3F));
+						newInformation.pred = node.id;
+						next.push_back(CoordinateNode{newId, newInformation.directionMove, int8_t(move.getFace())});
+					}
+				}
+			}
+
+			layer.swap(next);
+		}
+
+		return std::vector<Move>();
+	}
+
+	/**
+	 * Same search as coordinateSearch, with the first layers of the backward side taken
+	 * from the goal side computed once for every solve. The forward side stops as soon as
+	 * it reaches a state of the table, and the backward side resumes from its deepest layer
+	 * whenever it is the smaller frontier.
+	 * @param goal - goal side of the phase
+	 */
+	template <unsigned int Phase, bool Canonical>
+	static std::vector<Move> goalLayerSearch(const CubeState &problem, const GoalLayers &goal, SearchScratch &scratch,
+											 uint64_t &nodes, const SearchLimits &limits)
+	{
+		const MoveTables &tables = MoveTables::getInstance();
+		TKMetrics problemId = problem.phaseMetrics<Phase>();
+
+		VisitedTable &searchedSpace = scratch.visited;
+		searchedSpace.clear();
+		searchedSpace[problemId].directionMove = 0x80;
+
+		// Moves from the problem to a state, then to the goal through the backward side and the table
+		auto connect = [&](TKMetrics forwardId, TKMetrics backwardId, std::vector<Move> middle)
+		{
+			std::vector<Move> algorithm;
+			TKInformation information;
+
+			while (forwardId != problemId && searchedSpace.find(forwardId, information))
+			{
+				algorithm.insert(algorithm.begin(), Move(information.directionMove & 0x3F));
+				forwardId = information.pred;
+			}
+
+			algorithm.insert(algorithm.end(), middle.begin(), middle.end());
+
+			const GoalEntry *entry;
+			while ((entry = goal.find(backwardId)) == nullptr && searchedSpace.find(backwardId, information))
+			{
+				algorithm.push_back(Move(information.directionMove & 0x3F).inverse());
+				backwardId = information.pred;
+			}
+
+			for (; entry != nullptr && entry->depth > 0; entry = goal.find(backwardId))
+			{
+				algorithm.push_back(Move(entry->move));
+				backwardId = tables.updateMetrics<Phase>(backwardId, Move(entry->move));
+			}
+
+			return algorithm;
+		};
+
+		if (goal.find(problemId) != nullptr)
+			return connect(problemId, problemId, {});
+
+		std::vector<CoordinateNode> &forward = scratch.coordinateFrontiers[0];
+		forward.assign(1, CoordinateNode{problemId, 0x80, -1});
+
+		// The deepest layer of the table is only copied once the backward side grows
+		const std::vector<CoordinateNode> *backward = &goal.frontier();
+
+		std::vector<CoordinateNode> &next = scratch.coordinateChildren;
+		uint64_t expanded = 0;
+
+		while (!forward.empty() && !backward->empty())
+		{
+			const bool forwardSide = forward.size() <= backward->size();
+			const std::vector<CoordinateNode> &layer = forwardSide ? forward : *backward;
+			next.clear();
+
+			for (const CoordinateNode &node : layer)
+			{
+				if (expanded++ % LIMITS_CHECK_INTERVAL == 0 && limits.reached(nodes))
+					return std::vector<Move>();
+
+				const MoveList &legalMoves = PHASE_MOVE_LISTS<Phase, Canonical>[node.lastFace + 1];
+
+				for (uint8_t i = 0; i < legalMoves.size; i++)
+				{
+					Move move(legalMoves.moves[i]);
+					nodes++;
+
+					TKMetrics newId = tables.updateMetrics<Phase>(node.id, move);
+
+					// Closer to the goal than the layer being expanded
+					if (goal.find(newId) != nullptr)
+					{
+						if (forwardSide)
+							return connect(node.id, newId, {move});
+						continue;
+					}
+
+					TKInformation &newInformation = searchedSpace[newId];
+					uint8_t newDir = newInformation.directionMove;
+
+					if ((newDir & 0xC0) != 0 && (newDir & 0xC0) != (node.directionMove & 0xC0))
+					{
+						if (forwardSide)
+							return connect(node.id, newId, {move});
+						return connect(newId, node.id, {move.inverse()});
+					}
+
+					if (!newDir)
+					{
+						newInformation.directionMove = ((node.directionMove & 0xC0) | (move.code() & 0x3F));
+						newInformation.pred = node.id;
+						next.push_back(CoordinateNode{newId, newInformation.directionMove, int8_t(move.getFace())});
+					}
+				}
+			}
+
+			if (forwardSide)
+			{
+				forward.swap(next);
+			}
+			else
+			{
+				scratch.coordinateFrontiers[1].swap(next);
+				backward = &scratch.coordinateFrontiers[1];
+			}
+		}
+
+		return std::vector<Move>();
+	}
+
+	/**
+	 * Same search as layeredSearch, but each layer is expanded by a pool of threads.
+	 * Children go to a buffer per worker and are merged once the layer is done, the
+	 * first thread that meets the other direction stops the layer.
+	 * The algorithm has the same length as the serial one but may differ from it.
+	 * @param threads - number of threads expanding a layer
+	 * @param limits - the budget of generated states is only checked between layers
+	 */
+	template <unsigned int Phase, bool Canonical>
+	static std::vector<Move> parallelSearch(const CubeState &problem, unsigned int threads, SearchScratch &scratch,
+											uint64_t &nodes, const SearchLimits &limits)
+	{
+		struct Meeting
+		{
+			bool found = false;
+			TKMetrics oldId, newId;
+			Move move = Move(-1);
+			uint8_t oldDir = 0;
+		};
+
+		ThreadPool &pool = scratch.getPool(threads);
+		const unsigned int workers = pool.size();
+		const size_t branching = PHASE_MOVE_LISTS<Phase, false>[0].size;
+
+		CubeState goalState;
+
+		TKMetrics problemId = problem.phaseMetrics<Phase>(),
+				  goalId = goalState.phaseMetrics<Phase>();
+
+		ConcurrentVisitedTable &visited = scratch.sharedVisited;
+		visited.reserve(1);
+		visited.clear();
+		visited.insert(problemId, 0x80, problemId);
+		visited.insert(goalId, 0x40, goalId);
+
+		std::vector<FrontierNode> &forward = scratch.frontiers[0], &backward = scratch.frontiers[1];
+		forward.assign(1, FrontierNode{problem, problemId, 0x80, -1});
+		backward.assign(1, FrontierNode{goalState, goalId, 0x40, -1});
+
+		scratch.children.resize(workers);
+
+		std::vector<Meeting> meetings(workers);
+		std::vector<uint64_t> workerNodes(workers, 0);
+		// Set once the searches met or the limits were reached
+		std::atomic<bool> found(false);
+
+		while (!forward.empty() && !backward.empty())
+		{
+			uint64_t layerNodes = nodes;
+			for (uint64_t count : workerNodes)
+				layerNodes += count;
+
+			if (limits.reached(layerNodes))
+				break;
+
+			std::vector<FrontierNode> &frontier = forward.size() <= backward.size() ? forward : backward;
+
+			// Nothing can be inserted while the table grows
+			visited.reserve(visited.size() + frontier.size() * branching);
+
+			for (std::vector<FrontierNode> &children : scratch.children)
+				children.clear();
+
+			// A few blocks per worker so that stealing can even out the layer
+			const size_t blocks = std::min(frontier.size(), size_t(workers) * 8);
+			const size_t blockSize = (frontier.size() + blocks - 1) / blocks;
+
+			pool.run(blocks, [&](size_t block, unsigned int worker)
+					 {
+				std::vector<FrontierNode> &children = scratch.children[worker];
+				size_t end = std::min(frontier.size(), (block + 1) * blockSize);
+
+				// Counted locally and published once per block, the counters of the workers share a cache line
+				uint64_t blockNodes = 0;
+
+				for (size_t i = block * blockSize; i < end; i++)
+				{
+					if (found.load(std::memory_order_relaxed))
+						break;
+
+					// The budget of states is only checked between layers
+					if ((i - block * blockSize) % LIMITS_CHECK_INTERVAL == 0 && limits.reached(0))
+					{
+						found.store(true, std::memory_order_relaxed);
+						break;
+					}
+
+					const FrontierNode &node = frontier[i];
+
+					const MoveList &legalMoves = PHASE_MOVE_LISTS<Phase, Canonical>[node.lastFace + 1];
+
+					for (uint8_t k = 0; k < legalMoves.size; k++)
+					{
+						Move move(legalMoves.moves[k]);
+
+						CubeState newState = node.state.applyMove(move);
+						blockNodes++;
+
+						TKMetrics newId = newState.phaseMetrics<Phase>();
+						uint8_t newDir = (node.directionMove & 0xC0) | (move.code() & 0x3F);
+						uint8_t seenDir = visited.insert(newId, newDir, node.id);
+
+						if (seenDir == 0)
+						{
+							children.push_back(FrontierNode{newState, newId, newDir, int8_t(move.getFace())});
+						}
+						else if ((seenDir & 0xC0) != (node.directionMove & 0xC0))
+						{
+							meetings[worker] = Meeting{true, node.id, newId, move, node.directionMove};
+							found.store(true, std::memory_order_relaxed);
+							break;
+						}
+					}
+
+					if (meetings[worker].found)
+						break;
+				}
+
+				workerNodes[worker] += blockNodes; });
+
+			if (found.load())
+				break;
+
+			frontier.clear();
+			for (std::vector<FrontierNode> &children : scratch.children)
+				frontier.insert(frontier.end(), children.begin(), children.end());
+		}
+
+		for (uint64_t count : workerNodes)
+			nodes += count;
+
+		for (const Meeting &meeting : meetings)
+		{
+			if (meeting.found)
+				return connectPaths(visited, meeting.oldId, meeting.newId, meeting.move, meeting.oldDir, problemId, goalId);
+		}
+
+		return std::vector<Move>();
+	}
+
+	/**
+	 * Call a search specialized at compile time for a phase and for the pruning of the moves.
+	 * @param search - generic callable taking the phase and the pruning as integral constants
+	 */
+	template <typename Search>
+	static std::vector<Move> specialize(unsigned int phase, bool canonical, Search search)
+	{
+		using std::integral_constant;
+
+		switch (phase * 2 + canonical)
+		{
+		case 0:
+			return search(integral_constant<unsigned int, 0>(), std::false_type());
+		case 1:
+			return search(integral_constant<unsigned int, 0>(), std::true_type());
+		case 2:
+			return search(integral_constant<unsigned int, 1>(), std::false_type());
+		case 3:
+			return search(integral_constant<unsigned int, 1>(), std::true_type());
+		case 4:
+			return search(integral_constant<unsigned int, 2>(), std::false_type());
+		default:
+			return search(integral_constant<unsigned int, 2>(), std::true_type());
+		}
+	}
+
+	std::vector<Move> searchPhaseInterleaved(const CubeState &problem, unsigned int phase, bool canonical,
+											 SearchScratch &scratch, uint64_t &nodes, const SearchLimits &limits)
+	{
+		return specialize(phase, canonical, [&](auto p, auto c)
+						  { return interleavedSearch<decltype(p)::value, decltype(c)::value>(problem, scratch, nodes, limits); });
+	}
+
+	std::vector<Move> searchPhase(const CubeState &problem, unsigned int phase, bool canonical, SearchScratch &scratch,
+								  uint64_t &nodes, const SearchLimits &limits)
+	{
+		return specialize(phase, canonical, [&](auto p, auto c)
+						  { return layeredSearch<decltype(p)::value, decltype(c)::value>(problem, scratch, nodes, limits); });
+	}
+
+	std::vector<Move> searchPhaseBlocks(const CubeState &problem, unsigned int phase, bool canonical,
+										SearchScratch &scratch, uint64_t &nodes, const SearchLimits &limits)
+	{
+		return specialize(phase, canonical, [&](auto p, auto c)
+						  { return blockSearch<decltype(p)::value, decltype(c)::value>(problem, scratch, nodes, limits); });
+	}
+
+	std::vector<Move> searchPhaseCoordinates(const CubeState &problem, unsigned int phase, bool canonical,
+											 SearchScratch &scratch, uint64_t &nodes, const SearchLimits &limits)
+	{
+		return specialize(phase, canonical, [&](auto p, auto c)
+						  { return coordinateSearch<decltype(p)::value, decltype(c)::value>(problem, scratch, nodes, limits); });
+	}
+
+	std::vector<Move> searchPhaseGoalLayers(const CubeState &problem, unsigned int phase, bool canonical,
+											unsigned int goalDepth, SearchScratch &scratch, uint64_t &nodes,
+											const SearchLimits &limits)
+	{
+		const GoalLayers &goal = GoalLayers::getInstance(phase, goalDepth);
+
+		return specialize(phase, canonical, [&](auto p, auto c)
+						  { return goalLayerSearch<decltype(p)::value, decltype(c)::value>(problem, goal, scratch, nodes,
+																						   limits); });
+	}
+
+	std::vector<Move> searchPhaseParallel(const CubeState &problem, unsigned int phase, bool canonical,
+										  unsigned int threads, SearchScratch &scratch, uint64_t &nodes,
+										  const SearchLimits &limits)
+	{
+		return specialize(phase, canonical, [&](auto p, auto c)
+						  { return parallelSearch<decltype(p)::value, decltype(c)::value>(problem, threads, scratch, nodes,
+																						   limits); });
+	}
+}
@@ -0,0 +1,300 @@
+#include "cube/solutioncache.h"
+#include "cube/symmetry.h"
+#include "cube/tablefile.h"
+#include "cube/visitedtable.h"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace rubik
+{
+	// The entries of older files had no variant nor centers in their key
+	const static char *CACHE_TABLE_NAME = "solution_cache_3";
+
+	// Estimate of the memory of the hash map node of an entry
+	const static size_t INDEX_NODE_BYTES = 4 * sizeof(void *);
+
+	/**
+	 * @return the cubies of a state, the parity of its centers if the solver needs them
+	 * and the variant of the solver as a key
+	 */
+	static CacheKey stateKey(const CubeState &state, const CacheVariant &variant)
+	{
+		CacheKey key;
+
+		for (unsigned int i = 0; i < 2 * TOTAL_NUM_CUBIES; i++)
+			key[i] = state[i];
+
+		for (unsigned int i = 0; i < NUM_CENTERS; i++)
+			key[2 * TOTAL_NUM_CUBIES + i] = variant.centers ? state[2 * TOTAL_NUM_CUBIES + i] & 0b1 : 0;
+
+		key[CACHE_STATE_SIZE] = variant.engine;
+		for (unsigned int i = 0; i < sizeof(uint32_t); i++)
+			key[CACHE_STATE_SIZE + 1 + i] = uint8_t(variant.parameter >> (8 * i));
+
+		return key;
+	}
+
+	static uint64_t keyHash(const CacheKey &key)
+	{
+		return hashMetricsKey(tableChecksum(key.data(), key.size()));
+	}
+
+	CacheKey normalizeState(const CubeState &state, const CacheVariant &variant, unsigned int &symmetry)
+	{
+		CacheKey best = stateKey(state, variant);
+		symmetry = 0;
+
+		for (unsigned int s = 1; s < NUM_SYMMETRIES; s++)
+		{
+			CacheKey key = stateKey(conjugate(state, s), variant);
+
+			if (key < best)
+			{
+				best = key;
+				symmetry = s;
+			}
+		}
+
+		return best;
+	}
+
+	/**
+	 * @return a hash equal for all the conjugates of the state
+	 */
+	uint64_t normalizedStateHash(const CubeState &state, const CacheVariant &variant)
+	{
+		unsigned int symmetry;
+		return keyHash(normalizeState(state, variant, symmetry));
+	}
+
+	/**
+	 * @param maxBytes - memory cap of the entries, the least recently used ones are evicted first
+	 */
+	SolutionCache::SolutionCache(size_t maxBytes) : _hand(0), _maxBytes(maxBytes) {}
+
+	/**
+	 * Look for the solution of a state or of any of its conjugates.
+	 * @param state - state to solve
+	 * @param variant - solver asking, only its own solutions are returned
+	 * @param solution - set to the solution of the state if it was found
+	 * @return if the cache held a solution
+	 */
+	bool SolutionCache::find(const CubeState &state, const CacheVariant &variant, std::vector<Move> &solution)
+	{
+		unsigned int symmetry;
+		CacheKey representative = normalizeState(state, variant, symmetry);
+		uint64_t hash = keyHash(representative);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		auto found = _index.find(hash);
+		if (found == _index.end() || _entries[found->second].representative != representative)
+		{
+			_stats.misses++;
+			return false;
+		}
+
+		Entry &entry = _entries[found->second];
+		entry.referenced = true;
+		_stats.hits++;
+
+		// The representative is the state seen through the symmetry, undo it on the moves
+		unsigned int inverse = getSymmetry(symmetry).inverse;
+
+		solution.clear();
+		for (uint8_t code : entry.moves)
+			solution.push_back(conjugate(Move(int(code)), inverse));
+
+		return true;
+	}
+
+	/**
+	 * Keep the solution of a state for the state and all of its conjugates.
+	 * @param state - state that was solved
+	 * @param variant - solver that found the solution
+	 * @param solution - moves solving it
+	 */
+	void SolutionCache::insert(const CubeState &state, const CacheVariant &variant, const std::vector<Move> &solution)
+	{
+		unsigned int symmetry;
+		CacheKey representative = normalizeState(state, variant, symmetry);
+
+		std::vector<uint8_t> moves;
+		moves.reserve(solution.size());
+		for (const Move &move : solution)
+			moves.push_back(conjugate(move, symmetry).code());
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		store(keyHash(representative), representative, std::move(moves));
+	}
+
+	void SolutionCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_entries.clear();
+		_freeEntries.clear();
+		_index.clear();
+		_hand = 0;
+		_stats.entries = 0;
+		_stats.bytes = 0;
+	}
+
+	SolutionCacheStats SolutionCache::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _stats;
+	}
+
+	/**
+	 * Write the entries to a table file (see tablefile.h), representative then length
+	 * and codes of the moves for each of them.
+	 * @param path - file to write
+	 */
+	bool SolutionCache::save(const std::string &path) const
+	{
+		std::vector<uint8_t> data;
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			for (const Entry &entry : _entries)
+			{
+				if (!entry.used)
+					continue;
+
+				data.insert(data.end(), entry.representative.begin(), entry.representative.end());
+				data.push_back(uint8_t(entry.moves.size()));
+				data.insert(data.end(), entry.moves.begin(), entry.moves.end());
+			}
+		}
+
+		return saveTable(path, CACHE_TABLE_NAME, data.data(), data.size());
+	}
+
+	/**
+	 * Add the entries of a file written by save, within the memory cap.
+	 * @param path - file to read
+	 * @return if the file was read, false if it is missing or damaged
+	 */
+	bool SolutionCache::load(const std::string &path)
+	{
+		std::error_code error;
+		uintmax_t fileSize = std::filesystem::file_size(path, error);
+		if (error || fileSize < sizeof(TableFileHeader))
+			return false;
+
+		MappedTable table;
+		if (!table.map(path, CACHE_TABLE_NAME, fileSize - sizeof(TableFileHeader)))
+			return false;
+
+		const uint8_t *data = table.data();
+		size_t offset = 0;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		while (offset + CACHE_KEY_SIZE + 1 <= table.size())
+		{
+			CacheKey representative;
+			std::copy(data + offset, data + offset + CACHE_KEY_SIZE, representative.begin());
+			size_t length = data[offset + CACHE_KEY_SIZE];
+			offset += CACHE_KEY_SIZE + 1;
+
+			if (offset + length > table.size())
+				return false;
+
+			store(keyHash(representative), representative, std::vector<uint8_t>(data + offset, data + offset + length));
+			offset += length;
+		}
+
+		return true;
+	}
+
+	/**
+	 * Add or replace an entry, evicting others until it fits. The mutex must be held.
+	 */
+	void SolutionCache::store(uint64_t hash, const CacheKey &representative, std::vector<uint8_t> &&moves)
+	{
+		auto found = _index.find(hash);
+		if (found != _index.end())
+		{
+			Entry &entry = _entries[found->second];
+			_stats.bytes -= entryBytes(entry);
+
+			entry.representative = representative;
+			entry.moves = std::move(moves);
+			entry.referenced = true;
+
+			_stats.bytes += entryBytes(entry);
+			return;
+		}
+
+		Entry entry{hash, representative, std::move(moves), false, true};
+		size_t bytes = entryBytes(entry);
+		if (bytes > _maxBytes)
+			return;
+
+		while (_stats.bytes + bytes > _maxBytes && !_index.empty())
+			_freeEntries.push_back(evict());
+
+		size_t slot;
+		if (!_freeEntries.empty())
+		{
+			slot = _freeEntries.back();
+			_freeEntries.pop_back();
+			_entries[slot] = std::move(entry);
+		}
+		else
+		{
+			slot = _entries.size();
+			_entries.push_back(std::move(entry));
+		}
+
+		_index[hash] = slot;
+		_stats.insertions++;
+		_stats.entries++;
+		_stats.bytes += bytes;
+	}
+
+	/**
+	 * Turn the hand of the clock: referenced entries get a second chance, the first
+	 * one that was not referenced since the last turn is evicted.
+	 * @return the slot of the evicted entry
+	 */
+	size_t SolutionCache::evict()
+	{
+		while (true)
+		{
+			if (_hand >= _entries.size())
+				_hand = 0;
+
+			Entry &entry = _entries[_hand];
+			size_t slot = _hand++;
+
+			if (!entry.used)
+				continue;
+
+			if (entry.referenced)
+			{
+				entry.referenced = false;
+				continue;
+			}
+
+			_index.erase(entry.hash);
+			_stats.bytes -= entryBytes(entry);
+			_stats.entries--;
+			_stats.evictions++;
+
+			entry.used = false;
+			entry.moves = std::vector<uint8_t>();
+
+			return slot;
+		}
+	}
+
+	size_t SolutionCache::entryBytes(const Entry &entry)
+	{
+		return sizeof(Entry) + entry.moves.capacity() + INDEX_NODE_BYTES;
+	}
+}
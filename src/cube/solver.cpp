@@ -1,22 +1,257 @@
 #include "cube/solver.h"
+#include "cube/kociemba.h"
+#include "cube/korf.h"
+#include "cube/nearoptimal.h"
+#include "cube/phasesearch.h"
+#include "cube/solutioncache.h"
+#include "cube/statesimd.h"
+#include "cube/thistlethwaite.h"
 
 #include <iostream>
 #include <string>
-#include <map>
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <deque>
+#include <memory>
 
 namespace rubik
 {
-	struct TKInformation
+	const char *solveStatusName(SolveStatus status)
 	{
-		// State that was used to reach the current state
-		TKMetrics pred;
-		// Direction from which the state was reached (10 for unsolved, 01 for solved)
-		// and Move used to reach it
-		uint8_t directionMove;
-	};
+		switch (status)
+		{
+		case SolveStatus::SOLVED:
+			return "solved";
+		case SolveStatus::CANCELLED:
+			return "cancelled";
+		case SolveStatus::TIMED_OUT:
+			return "timed_out";
+		case SolveStatus::NODE_LIMIT:
+			return "node_limit";
+		case SolveStatus::NOT_FOUND:
+			return "not_found";
+		}
+
+		return "unknown";
+	}
+
+	/**
+	 * Tell which of the limits stopped a search.
+	 * @param limits - limits of the search
+	 * @param nodes - number of states the search generated
+	 */
+	SolveStatus stoppedStatus(const SearchLimits &limits, uint64_t nodes)
+	{
+		if (limits.stop.stop_requested())
+			return SolveStatus::CANCELLED;
+		if (limits.maxNodes != 0 && nodes >= limits.maxNodes)
+			return SolveStatus::NODE_LIMIT;
+
+		return SolveStatus::TIMED_OUT;
+	}
+
+	/**
+	 * @return the solver of the options as the solution cache tells them apart
+	 */
+	static CacheVariant cacheVariant(const SolverOptions &options)
+	{
+		CacheVariant variant;
+		variant.engine = uint8_t(options.engine);
+		variant.centers = options.engine == SolverEngine::THISTLETHWAITE_KOCIEMBA ||
+						  options.engine == SolverEngine::NEAR_OPTIMAL;
+
+		if (options.engine == SolverEngine::KOCIEMBA)
+			variant.parameter = options.maxSolutionLength;
+		else if (options.engine == SolverEngine::NEAR_OPTIMAL)
+			variant.parameter = uint32_t(std::lround(
+				1000.0 * (options.timeLimit > 0.0 ? options.timeLimit : NEAR_OPTIMAL_DEFAULT_SECONDS)));
+
+		return variant;
+	}
+
+	/**
+	 * Solve a state with the engine chosen in the options.
+	 * @param problem - state of the cube to solve
+	 * @param options - engine, its parameters, the budget of the solve and its cache
+	 * @param onMove - receives the moves of the solution as they are found
+	 * @param scratch - memory of the search to reuse, with the threads of the parallel searches,
+	 * allocated and started for this solve if not given
+	 * @param stop - cancels the solve when requested
+	 * @return solution with the time, nodes and moves of each phase
+	 */
+	SolveReport solveState(const CubeState &problem, const SolverOptions &options, const MoveCallback &onMove,
+						   SearchScratch *scratch, std::stop_token stop)
+	{
+		SolveReport report;
+		std::queue<Move> solution;
+
+		if (options.cache != nullptr)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			if (options.cache->find(problem, cacheVariant(options), report.solution))
+			{
+				std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+				report.seconds = duration.count();
+				report.cached = true;
+
+				if (onMove)
+				{
+					for (const Move &move : report.solution)
+						onMove(move);
+				}
+
+				return report;
+			}
+		}
+
+		SearchLimits limits{stop, std::chrono::steady_clock::time_point::max(), options.nodeLimit};
+		if (options.timeLimit > 0.0)
+			limits.deadline = std::chrono::steady_clock::now() +
+							  std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+								  std::chrono::duration<double>(options.timeLimit));
+
+		if (options.engine != SolverEngine::THISTLETHWAITE_KOCIEMBA)
+		{
+			if (options.engine == SolverEngine::KOCIEMBA)
+				solution = kociemba(problem, options.maxSolutionLength, &report, limits);
+			else if (options.engine == SolverEngine::OPTIMAL && scratch != nullptr)
+				solution = korf(problem, scratch->getPool(options.optimalThreads), &report, limits);
+			else if (options.engine == SolverEngine::OPTIMAL)
+				solution = korf(problem, options.optimalThreads, &report, limits);
+			else if (options.engine == SolverEngine::NEAR_OPTIMAL)
+			{
+				// The solution only stops improving at the deadline, there must be one
+				SearchLimits nearLimits = limits;
+				if (options.timeLimit <= 0.0)
+					nearLimits.deadline = std::chrono::steady_clock::now() +
+										  std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+											  std::chrono::duration<double>(NEAR_OPTIMAL_DEFAULT_SECONDS));
+
+				if (scratch != nullptr)
+					solution = nearOptimal(problem, options, scratch->getPool(options.optimalThreads), &report,
+										   nearLimits);
+				else
+					solution = nearOptimal(problem, options, &report, nearLimits);
+			}
+			else
+				solution = thistlethwaite(problem, &report);
+
+			if (onMove)
+			{
+				std::queue<Move> moves = solution;
+				while (!moves.empty())
+				{
+					onMove(moves.front());
+					moves.pop();
+				}
+			}
+		}
+		else
+		{
+			solution = thistlethwaiteKociemba(problem, options, onMove, &report, scratch, limits);
+		}
+
+		report.solution.reserve(solution.size());
+		while (!solution.empty())
+		{
+			report.solution.push_back(solution.front());
+			solution.pop();
+		}
+
+		if (options.cache != nullptr && report.status == SolveStatus::SOLVED)
+			options.cache->insert(problem, cacheVariant(options), report.solution);
+
+		return report;
+	}
+
+	/**
+	 * Solve many states on a pool of threads. Each worker keeps its own search memory
+	 * from one job to the next of the call and the reports are in the same order as the problems,
+	 * whatever the number of threads.
+	 * @param problems - states to solve
+	 * @param options - engine and its parameters
+	 * @param pool - threads to solve on
+	 */
+	std::vector<SolveReport> solveMany(const std::vector<CubeState> &problems, const SolverOptions &options,
+									   ThreadPool &pool)
+	{
+		std::vector<SearchScratch> scratches(pool.size());
+		return solveMany(problems, options, pool, scratches);
+	}
+
+	/**
+	 * Solve many states on a pool of threads with search memory kept by the caller, so
+	 * that successive batches reuse it instead of allocating it again.
+	 * Every worker solves its own problems, and the parallel searches of a problem run on
+	 * the threads kept by the scratch of the worker, started once for all its solves. The
+	 * optimal searches left on every hardware thread get an equal share of them instead,
+	 * so that the workers do not run more threads than the cores between them.
+	 * @param scratches - search memory of each worker, at least one per thread of the pool
+	 */
+	std::vector<SolveReport> solveMany(const std::vector<CubeState> &problems, const SolverOptions &options,
+									   ThreadPool &pool, std::vector<SearchScratch> &scratches)
+	{
+		std::vector<SolveReport> reports(problems.size());
+
+		SolverOptions workerOptions = options;
+		if (options.optimalThreads == 0)
+			workerOptions.optimalThreads = std::max(1u, ThreadPool::workerCount(0) / pool.size());
+
+		pool.run(problems.size(), [&](size_t job, unsigned int worker)
+				 { reports[job] = solveState(problems[job], workerOptions, nullptr, &scratches[worker]); });
+
+		return reports;
+	}
+
+	/**
+	 * Solve many states on a temporary pool.
+	 * @param threads - number of threads, 0 for one per hardware thread
+	 */
+	std::vector<SolveReport> solveMany(const std::vector<CubeState> &problems, const SolverOptions &options,
+									   unsigned int threads)
+	{
+		ThreadPool pool(threads);
+		return solveMany(problems, options, pool);
+	}
+
+	/**
+	 * Print a report the way the application always did: time, peak of the visited
+	 * table, why the solve stopped early if it did and the solution.
+	 * @param s - stream to print to
+	 * @param report - report of the solve
+	 */
+	void printSolveReport(std::ostream &s, const SolveReport &report)
+	{
+		s << "Time: " << report.seconds << " seconds" << std::endl;
+
+		uint64_t nodes = 0;
+		for (const PhaseReport &phase : report.phases)
+			nodes += phase.nodes;
+
+		if (nodes > 0 && report.seconds > 0.0)
+			s << "Nodes: " << nodes << " (" << uint64_t(nodes / report.seconds) << " per second)" << std::endl;
+
+		if (report.peakVisited > 0)
+			s << "Visited: peak " << report.peakVisited << " states" << std::endl;
+
+		if (report.status != SolveStatus::SOLVED)
+			s << "Stopped: " << solveStatusName(report.status) << std::endl;
+
+		if (report.cached)
+			s << "Solution from the cache" << std::endl;
+
+		if (!report.solution.empty())
+		{
+			s << "<SOLUTION> " << report.solution.size() << " moves: ";
+
+			for (const Move &move : report.solution)
+				s << move << " ";
+
+			s << std::endl;
+		}
+	}
 
 	/**
 	 * Compute an algorithm to solve the current scrambled state of the cube
@@ -24,11 +259,36 @@ namespace rubik
 	 * The idea is to use the metrics of the Kociemba but with the last phase split into two parts:
 	 * the first one is similar to the Thistlethwaite while the second phase is the Kociemba's.
 	 * @param problem - state of the cube to solve
+	 * @param options - number of threads and kind of search expanding the frontiers
+	 * @param onMove - receives the moves of the solution as they are found
+	 * @param report - filled with the time, nodes, moves and memory of each phase if given
+	 * @param scratch - memory of the search to reuse, allocated for this solve if not given
+	 * @param limits - stops the solve after the last complete phase once reached
 	 */
-	std::queue<Move> thistlethwaiteKociemba(Cube *cube, CubeState problem)
+	std::queue<Move> thistlethwaiteKociemba(CubeState problem, const SolverOptions &options, const MoveCallback &onMove,
+											SolveReport *report, SearchScratch *scratch, const SearchLimits &limits)
 	{
 		auto start = std::chrono::steady_clock::now();
 
+		std::unique_ptr<SearchScratch> ownScratch;
+		if (scratch == nullptr)
+		{
+			ownScratch = std::make_unique<SearchScratch>();
+			scratch = ownScratch.get();
+		}
+
+		const size_t scratchBytes = scratch->bytes();
+
+		// A scratch kept between solves would report the largest peak of all of them
+		scratch->visited.reset();
+		scratch->sharedVisited.reset();
+
+		if (report != nullptr)
+		{
+			*report = SolveReport();
+			report->phases.resize(THISTLETHWAITE_KOCIEMBA_PHASE_COUNT);
+		}
+
 		std::deque<Move> solution;
 		CubeState currentState = problem;
 
@@ -36,139 +296,111 @@ namespace rubik
 		CubeState goalState;
 
 		Move lastMove = Move(-1);
+		SolveStatus status = SolveStatus::SOLVED;
+		uint64_t totalNodes = 0;
 
-		int phase = 0;
-
-		std::map<TKMetrics, TKInformation> searchedSpace;
-
-		while (phase < THISTLETHWAITE_KOCIEMBA_PHASE_COUNT)
+		for (unsigned int phase = 0; phase < THISTLETHWAITE_KOCIEMBA_PHASE_COUNT; phase++)
 		{
-			TKMetrics currentId = currentState.thistlethwaiteKociembaId(phase),
-					  goalId = goalState.thistlethwaiteKociembaId(phase);
+			auto phaseStart = std::chrono::steady_clock::now();
+			uint64_t nodes = 0;
 
 			// Skip the phase if already solved
-			if (currentId == goalId)
-			{
-				phase++;
+			if (currentState.thistlethwaiteKociembaId(phase) == goalState.thistlethwaiteKociembaId(phase))
 				continue;
-			}
 
-			/* BFS QUEUE */
-			std::queue<CubeState> q;
-			q.push(currentState);
-			q.push(goalState);
-
-			/* BFS TABLES */
-			searchedSpace[currentId].directionMove |= 0x80;
-			searchedSpace[goalId].directionMove |= 0x40;
+			// The budget of states is shared by all the phases
+			SearchLimits phaseLimits = limits;
+			if (limits.maxNodes != 0)
+				phaseLimits.maxNodes = limits.maxNodes > totalNodes ? limits.maxNodes - totalNodes : 1;
+
+			// The first phase has vector kernels of its own, faster per state than a block
+			std::vector<Move> algorithm;
+			if (options.searchThreads > 1)
+				algorithm = searchPhaseParallel(currentState, phase, options.canonicalPruning, options.searchThreads,
+												*scratch, nodes, phaseLimits);
+			else if (options.layeredSearch && options.goalDepth > 0)
+				algorithm = searchPhaseGoalLayers(currentState, phase, options.canonicalPruning, options.goalDepth,
+												  *scratch, nodes, phaseLimits);
+			else if (options.layeredSearch && options.incrementalMetrics)
+				algorithm = searchPhaseCoordinates(currentState, phase, options.canonicalPruning, *scratch, nodes,
+												   phaseLimits);
+			else if (options.layeredSearch && options.blockExpansion &&
+					 (phase != 0 || getSimdLevel() == SimdLevel::SCALAR))
+				algorithm = searchPhaseBlocks(currentState, phase, options.canonicalPruning, *scratch, nodes,
+											  phaseLimits);
+			else if (options.layeredSearch)
+				algorithm = searchPhase(currentState, phase, options.canonicalPruning, *scratch, nodes, phaseLimits);
+			else
+				algorithm = searchPhaseInterleaved(currentState, phase, options.canonicalPruning, *scratch, nodes,
+												   phaseLimits);
+
+			totalNodes += nodes;
+
+			// Keep the phases already solved as the best partial result
+			if (algorithm.empty())
+			{
+				status = stoppedStatus(phaseLimits, nodes);
 
-			bool finishedPhase = false;
+				if (report != nullptr)
+				{
+					std::chrono::duration<double> phaseDuration = std::chrono::steady_clock::now() - phaseStart;
+					report->phases[phase] = PhaseReport{phaseDuration.count(), nodes, 0, 0};
+				}
+				break;
+			}
 
-			while (!finishedPhase)
+			if (solution.size() > 0)
 			{
-				// State to explore from
-				CubeState oldState = q.front();
-				q.pop();
+				currentState.applyMoveInPlace(lastMove.inverse());
+				algorithm.insert(algorithm.begin(), lastMove);
+				solution.pop_back();
+			}
 
-				TKMetrics oldId = oldState.thistlethwaiteKociembaId(phase);
-				uint8_t &oldDir = searchedSpace[oldId].directionMove;
+			std::queue<Move> optimized = optimizeSolution(algorithm);
+			unsigned int movesBefore = algorithm.size();
+			int totalSize = optimized.size();
 
-				// Explore all the legal moves for new states
-				for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES && !finishedPhase; m++)
+			// Apply the algorithm to the scrambled state
+			for (int i = 0; i < totalSize; i++)
+			{
+				Move newMove = optimized.front();
+				optimized.pop();
+				solution.push_back(newMove);
+				currentState.applyMoveInPlace(newMove);
+
+				// Dont apply last move of the phase to the physical cube.
+				// It can sometimes be optimized and remove useless moves.
+				if (i != totalSize - 1)
 				{
-					if (THISTLETHWAITE_MOVES[phase] & (1 << m))
-					{
-						Move move(m);
-
-						CubeState newState = oldState.applyMove(move);
-
-						TKMetrics newId = newState.thistlethwaiteKociembaId(phase);
-						uint8_t &newDir = searchedSpace[newId].directionMove;
-
-						// The new state has already been seen and it has a different direction.
-						// This means that the scrambled and solved states are now connected.
-						if ((newDir & 0xC0 != 0) && (newDir & 0xC0) != (oldDir & 0xC0))
-						{
-							// If the state comes from the solved state, invert the moves.
-							if ((oldDir & 0x40) == 0x40)
-							{
-								TKMetrics temp = oldId;
-								oldId = newId;
-								newId = temp;
-								move = move.inverse();
-							}
-
-							std::vector<Move> algorithm(1, move);
-
-							// Connect the positive path
-							while (oldId != currentId)
-							{
-								algorithm.insert(algorithm.begin(), Move(searchedSpace[oldId].directionMove & 0x3F));
-								oldId = searchedSpace[oldId].pred;
-							}
-
-							// Connect the negative path
-							while (newId != goalId)
-							{
-								algorithm.push_back(Move(searchedSpace[newId].directionMove & 0x3F).inverse());
-								newId = searchedSpace[newId].pred;
-							}
-
-							if (solution.size() > 0)
-							{
-								currentState = currentState.applyMove(lastMove.inverse());
-								algorithm.insert(algorithm.begin(), lastMove);
-								solution.pop_back();
-							}
-
-							std::queue<Move> optimized = optimizeSolution(algorithm);
-							int totalSize = optimized.size();
-
-							// Apply the algorithm to the scrambled state
-							for (int i = 0; i < totalSize; i++)
-							{
-								Move newMove = optimized.front();
-								optimized.pop();
-								solution.push_back(newMove);
-								currentState = currentState.applyMove(newMove);
-
-								// Dont apply last move of the phase to the physical cube.
-								// It can sometimes be optimized and remove useless moves.
-								if (i != totalSize - 1)
-								{
-									cube->turnFace(newMove);
-								}
-								else
-								{
-									lastMove = newMove;
-								}
-							}
-							searchedSpace.clear();
-							finishedPhase = true;
-						}
-
-						// State was never seen. Update the tables and set the direction.
-						if (!newDir)
-						{
-							q.push(newState);
-							newDir = ((oldDir & 0xC0) | (move.code() & 0x3F));
-							searchedSpace[newId].pred = oldId;
-						}
-					}
+					if (onMove)
+						onMove(newMove);
+				}
+				else
+				{
+					lastMove = newMove;
 				}
 			}
-			phase++;
+
+			if (report != nullptr)
+			{
+				std::chrono::duration<double> phaseDuration = std::chrono::steady_clock::now() - phaseStart;
+				report->phases[phase] = PhaseReport{phaseDuration.count(), nodes, movesBefore, unsigned(totalSize)};
+			}
 		}
-		if (solution.size() > 0)
+		if (solution.size() > 0 && onMove)
 		{
-			cube->turnFace(lastMove);
+			onMove(lastMove);
 		}
 
-		auto end = std::chrono::steady_clock::now();
-
-		std::chrono::duration<double> duration = end - start;
-
-		std::cout << "Time: " << duration.count() << " seconds" << std::endl;
+		if (report != nullptr)
+		{
+			std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+			report->status = status;
+			report->seconds = duration.count();
+			report->peakVisited = std::max(scratch->visited.getStats().peakSize, scratch->sharedVisited.peakSize());
+			report->scratchBytes = scratch->bytes();
+			report->scratchGrowthBytes = report->scratchBytes > scratchBytes ? report->scratchBytes - scratchBytes : 0;
+		}
 
 		return std::queue(solution);
 	}
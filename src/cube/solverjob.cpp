@@ -0,0 +1,51 @@
+#include "cube/solverjob.h"
+
+#include <chrono>
+
+namespace rubik
+{
+	/**
+	 * Start solving a state.
+	 * @param problem - state of the cube to solve
+	 * @param options - engine, its parameters and the budget of the solve
+	 * @param onMove - receives the moves of the solution as they are found, on the thread of the job
+	 */
+	SolverJob::SolverJob(const CubeState &problem, const SolverOptions &options, const MoveCallback &onMove)
+	{
+		std::promise<SolveReport> promise;
+		_report = promise.get_future().share();
+
+		_thread = std::jthread([problem, options, onMove, promise = std::move(promise)](std::stop_token stop) mutable
+							   {
+			try
+			{
+				promise.set_value(solveState(problem, options, onMove, nullptr, stop));
+			}
+			catch (...)
+			{
+				promise.set_exception(std::current_exception());
+			} });
+	}
+
+	/**
+	 * Ask the search to stop. The report is ready shortly after, with a CANCELLED
+	 * status unless the solve was already over.
+	 */
+	void SolverJob::cancel()
+	{
+		_thread.request_stop();
+	}
+
+	/**
+	 * @return if the report is ready
+	 */
+	bool SolverJob::isDone() const
+	{
+		return _report.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	std::shared_future<SolveReport> SolverJob::getReport() const
+	{
+		return _report;
+	}
+}
@@ -1,10 +1,27 @@
 #include "cube/state.h"
+#include "cube/coordinates.h"
+#include "cube/statesimd.h"
+
+#include <algorithm>
+#include <tuple>
 
 namespace rubik
 {
+	// The vector kernels need the coordinate tables, built on first use
+	[[maybe_unused]] static const bool SIMD_SELECTED = setSimdLevel(detectSimdLevel());
+
+	/**
+	 * @param move - move to query
+	 * @return the precomputed effect of the move on the cubies
+	 */
+	const MovePermutation &getMovePermutation(const Move &move)
+	{
+		return MOVE_PERMUTATIONS[move.code()];
+	}
+
 	CubeState::CubeState()
 	{
-		_state = std::vector<uint8_t>(2 * TOTAL_NUM_CUBIES + NUM_CENTERS, 0);
+		_state.fill(0);
 
 		for (int i = 0; i < TOTAL_NUM_CUBIES; i++)
 		{
@@ -12,206 +29,110 @@ namespace rubik
 		}
 	}
 
-	CubeState::CubeState(std::vector<uint8_t> &s)
+	CubeState::CubeState(const std::vector<uint8_t> &s)
 	{
-		_state = s;
+		_state.fill(0);
+		std::copy_n(s.begin(), std::min<size_t>(s.size(), STATE_SIZE), _state.begin());
 	}
 
+	CubeState::CubeState(const std::array<uint8_t, PACKED_STATE_SIZE> &s) : _state(s) {}
+
 	/**
 	 * Calculate the new state after a given move is applied.
 	 * @param move - move to apply
 	 */
 	CubeState CubeState::applyMove(const Move &move) const
 	{
-		int turns = move.getTurns();
-		int face = move.getFace();
-
-		std::vector<uint8_t> current_state = this->_state;
+		CubeState next = *this;
+		next.applyMoveInPlace(move);
+		return next;
+	}
 
-		for (int t = 0; t < turns; t++)
+	/**
+	 * Apply a move directly on this state. Never allocates.
+	 * Uses the vector kernel of the CPU if there is one (see statesimd.h).
+	 * @param move - move to apply
+	 */
+	void CubeState::applyMoveInPlace(const Move &move)
+	{
+		if (STATE_KERNELS.applyMove != nullptr)
 		{
-			std::vector<uint8_t> oldState = current_state;
-
-			for (int i = 0; i < 8; i++)
-			{
-				int isCorner = (i >= 4);
-
-				// Swap (0 <- 1 <- 2 <- 3 <- 0) for both edges and corners
-				int target = AFFECTED_CUBIES[face][i] + isCorner * NUM_EDGES;
-
-				int newIndex = 0;
-				if (i % 4 == 3)
-					newIndex = i - 3;
-				else
-					newIndex = i + 1;
-				int newVal = AFFECTED_CUBIES[face][newIndex] + isCorner * NUM_EDGES;
-
-				int orientationDelta = 0;
-
-				// Edges only change orientation with one pair of move types.
-				// The two other pair can always replace the edges to their original state,
-				// but the last pair flips the edge piece.
-				if (i <= 3)
-					orientationDelta = (face == 2 || face == 3);
+			STATE_KERNELS.applyMove(_state.data(), move.code());
+			return;
+		}
 
-				// Corners always change except with up or down moves.
-				else if (face <= 1)
-					orientationDelta = 0;
+		const MovePermutation &permutation = MOVE_PERMUTATIONS[move.code()];
+		const std::array<uint8_t, PACKED_STATE_SIZE> oldState = _state;
 
-				/*
-				 * Corner 0: +1 (F) +2 (R)
-				 * Corner 1: +1 (R) +2 (B)
-				 * Corner 2: +1 (B) +2 (L)
-				 * Corner 3: +1 (L) +2 (F)
-				 * Corner 4: +1 (R) +2 (F)
-				 * Corner 5: +1 (F) +2 (L)
-				 * Corner 6: +1 (L) +2 (B)
-				 * Corner 7: +1 (B) +2 (R)
-				 */
-				else
-					orientationDelta = 2 - (i % 2);
+		for (int i = 0; i < TOTAL_NUM_CUBIES; i++)
+		{
+			int source = permutation.source[i];
+			int modulo = 2 + (i >= NUM_EDGES);
 
-				/*
-				Move and change orientation
-				*/
-				current_state[target] = oldState[newVal];
-				current_state[target + TOTAL_NUM_CUBIES] =
-					oldState[newVal + TOTAL_NUM_CUBIES] + orientationDelta;
+			_state[i] = oldState[source];
 
-				// Clamp the orientation
-				current_state[target + TOTAL_NUM_CUBIES] %= 2 + isCorner;
-			}
+			int orientation = oldState[source + TOTAL_NUM_CUBIES] + permutation.orientation[i];
+			_state[i + TOTAL_NUM_CUBIES] = orientation - modulo * (orientation >= modulo);
 		}
 
-		current_state[2 * TOTAL_NUM_CUBIES + face] += turns;
-		current_state[2 * TOTAL_NUM_CUBIES + face] %= 4;
-
-		return current_state;
+		int face = move.getFace();
+		_state[2 * TOTAL_NUM_CUBIES + face] = (_state[2 * TOTAL_NUM_CUBIES + face] + move.getTurns()) & 0b11;
 	}
 
 	/**
-	 * Compute the metrics for the thistlethwaite-kociemba algorithm depending on the phase.
-	 * @param phase - current phase of the algorithm
+	 * Metrics of a phase known at compile time, used by the specialized searches.
 	 */
-	TKMetrics CubeState::thistlethwaiteKociembaId(unsigned int phase) const
+	template <unsigned int Phase>
+	TKMetrics CubeState::phaseMetrics() const
 	{
-		TKMetrics metrics{0, 0, 0, 0};
 		// Phase 1: Orientations and middle slice edges
-		if (phase == 0)
+		if constexpr (Phase == 0)
 		{
+			if (STATE_KERNELS.phase0Metrics != nullptr)
+				return STATE_KERNELS.phase0Metrics(_state.data());
 
-			// Orientation of the corners
-			for (int e = TOTAL_NUM_CUBIES + NUM_EDGES; e < 2 * TOTAL_NUM_CUBIES; e++)
-			{
-				metrics.m1 *= 3;
-				metrics.m1 += _state[e];
-			}
-
-			// Store a bit of 1 at the position of the edges
-			// in the slice between Red(U) and Orange(D) in their solved state
-			// Place all the middle edges in their slice
-			for (int e = 0; e < NUM_EDGES; e++)
-				metrics.m2 |= (_state[e] / (NUM_EDGES - NUM_MIDDLE_EDGES)) << e;
-
-			// Orientation of the edges
-			for (int e = TOTAL_NUM_CUBIES; e < TOTAL_NUM_CUBIES + NUM_EDGES - 1; e++)
-			{
-				metrics.m3 *= 2;
-				metrics.m3 += _state[e];
-			}
-
-			// Rough orientation of the F, B, L and R centers. Must be a half-turn
-			// away from solved
-			for (int c = 2; c < NUM_CENTERS; c++)
-			{
-				metrics.m4 *= 2;
-				metrics.m4 += _state[2 * TOTAL_NUM_CUBIES + c] & 0b1;
-			}
-
-			return metrics;
+			return TKMetrics{cornerTwist(*this), sliceCombination(*this),
+							 edgeFlip(*this), sideCenterParity(*this)};
 		}
 
 		// Phase 3: Consider the rough position of the edges, the rough position of the corners
-		else if (phase == 1)
-		{
-			// Store '11' for edges in the middle slice or either '01' or '00' for other edges
-			// depending on if they are odd or even.
-			// Checks overall edge location
-			for (int e = 0; e < NUM_EDGES; e++)
-				metrics.m1 |= ((_state[e] >= 8) ? 0b11 : ((int)(_state[e] & 0b1)) << (2 * e));
-
-			// Store '1' as the first bit if the corner is on the bottom slice.
-			// Store '1' as the third bit if the corner is on the diagonal L->R/F->B
-			// Checks if the corner is in the correct slice and on the right diagonal
-			for (int c = 0; c < NUM_CORNERS; c++)
-				metrics.m2 |= ((int)(_state[c + NUM_EDGES] - NUM_EDGES) & 0b101) << (3 * c);
-
-			// Check if the number of permutations between corners is even.
-			// From a solved state, if pairs of corners where swapped an odd
-			// number of times, this will be a '1' and if the number of times
-			// was even, this will be a '0'.
-			for (int i = NUM_EDGES; i < TOTAL_NUM_CUBIES; i++)
-			{
-				for (int j = i + 1; j < TOTAL_NUM_CUBIES; j++)
-				{
-					metrics.m3 ^= (_state[i] > _state[j]);
-				}
-			}
-
-			return metrics;
-		}
-
-		// Phase 4: Consider the positions of each cubies
-
-		// Corner permutations
-		for (int i = NUM_CORNERS - 1; i >= 1; i--)
+		// and the parity of the corners.
+		else if constexpr (Phase == 1)
 		{
-
-			for (int j = i - 1; j >= 0; j--)
-			{
-				metrics.m1 += (_state[i + NUM_EDGES] < _state[j + NUM_EDGES]);
-			}
-
-			metrics.m1 *= i;
+			return TKMetrics{edgeTetrad(*this), cornerTetrad(*this), cornerParity(*this), 0};
 		}
 
-		// Top and bottom edge permutations
-		for (int i = NUM_EDGES - NUM_MIDDLE_EDGES - 1; i >= 1; i--)
+		// Phase 4: Consider the positions of each cubies and the rough orientation
+		// of the U and D centers.
+		else
 		{
-
-			for (int j = i - 1; j >= 0; j--)
-			{
-				metrics.m2 += (_state[i] < _state[j]);
-			}
-
-			metrics.m2 *= i;
+			return TKMetrics{cornerPermutation(*this), edgePermutation(*this),
+							 slicePermutation(*this), udCenterParity(*this)};
 		}
+	}
 
-		// Middle slice permutations
-		for (int i = NUM_MIDDLE_EDGES - 1; i >= 1; i--)
-		{
-
-			for (int j = i - 1; j >= 0; j--)
-			{
-				metrics.m3 += (_state[i + 8] < _state[j + 8]);
-			}
-
-			metrics.m3 *= i;
-		}
+	template TKMetrics CubeState::phaseMetrics<0>() const;
+	template TKMetrics CubeState::phaseMetrics<1>() const;
+	template TKMetrics CubeState::phaseMetrics<2>() const;
 
-		// Rough orientation of the U and D centers.
-		for (int c = 0; c < 2; c++)
-		{
-			metrics.m4 *= 2;
-			metrics.m4 += _state[2 * TOTAL_NUM_CUBIES + c] & 1;
-		}
+	/**
+	 * Compute the metrics for the thistlethwaite-kociemba algorithm depending on the phase.
+	 * Every metric is a coordinate so that MoveTables can update it without the cubies.
+	 * @param phase - current phase of the algorithm
+	 */
+	TKMetrics CubeState::thistlethwaiteKociembaId(unsigned int phase) const
+	{
+		if (phase == 0)
+			return phaseMetrics<0>();
+		else if (phase == 1)
+			return phaseMetrics<1>();
 
-		return metrics;
+		return phaseMetrics<2>();
 	}
 
 	int CubeState::size() const
 	{
-		return _state.size();
+		return STATE_SIZE;
 	}
 
 	/**
@@ -223,6 +144,11 @@ namespace rubik
 		return this->_state < other_state._state;
 	}
 
+	bool CubeState::operator==(const CubeState &other_state) const
+	{
+		return this->_state == other_state._state;
+	}
+
 	int CubeState::operator[](const int i) const
 	{
 		return this->_state[i];
@@ -234,7 +160,7 @@ namespace rubik
 	 */
 	std::ostream &operator<<(std::ostream &s, const CubeState &state)
 	{
-		for (int i = 0; i < 2 * TOTAL_NUM_CUBIES + 6; i++)
+		for (int i = 0; i < STATE_SIZE; i++)
 		{
 			s << state[i];
 		}
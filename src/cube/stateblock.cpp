@@ -0,0 +1,196 @@
+#include "cube/stateblock.h"
+#include "cube/coordinates.h"
+
+namespace rubik
+{
+	/*
+	Every loop below runs over the STATE_BLOCK_SIZE lanes of one or a few rows,
+	with the same arithmetic as the scalar coordinates (uint16_t ranks that may
+	wrap the same way), so the results are identical to thistlethwaiteKociembaId.
+	*/
+
+	void StateBlock::set(unsigned int lane, const CubeState &state)
+	{
+		for (int i = 0; i < PACKED_STATE_SIZE; i++)
+			rows[i][lane] = state[i];
+	}
+
+	CubeState StateBlock::get(unsigned int lane) const
+	{
+		std::array<uint8_t, PACKED_STATE_SIZE> state;
+
+		for (int i = 0; i < PACKED_STATE_SIZE; i++)
+			state[i] = rows[i][lane];
+
+		return CubeState(state);
+	}
+
+	/**
+	 * Turn every state of a block. All the lanes are computed, used or not.
+	 * @param parents - states to turn
+	 * @param move - move to apply
+	 * @param children - receives the turned states
+	 */
+	void applyMoveBlock(const StateBlock &parents, const Move &move, StateBlock &children)
+	{
+		const MovePermutation &permutation = getMovePermutation(move);
+
+		for (int i = 0; i < TOTAL_NUM_CUBIES; i++)
+		{
+			const uint8_t *cubies = parents.rows[permutation.source[i]];
+			const uint8_t *orientations = parents.rows[permutation.source[i] + TOTAL_NUM_CUBIES];
+			uint8_t *newCubies = children.rows[i];
+			uint8_t *newOrientations = children.rows[i + TOTAL_NUM_CUBIES];
+
+			const uint8_t delta = permutation.orientation[i];
+			const uint8_t modulo = 2 + (i >= NUM_EDGES);
+
+			for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+			{
+				uint8_t orientation = orientations[k] + delta;
+
+				newCubies[k] = cubies[k];
+				newOrientations[k] = orientation >= modulo ? orientation - modulo : orientation;
+			}
+		}
+
+		const int turned = 2 * TOTAL_NUM_CUBIES + move.getFace();
+		const uint8_t turns = move.getTurns();
+
+		for (int i = 2 * TOTAL_NUM_CUBIES; i < PACKED_STATE_SIZE; i++)
+		{
+			for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+				children.rows[i][k] = i == turned ? (parents.rows[i][k] + turns) & 0b11 : parents.rows[i][k];
+		}
+
+		children.size = parents.size;
+	}
+
+	/**
+	 * Lehmer rank of n cubies starting at a row, see cornerPermutation.
+	 */
+	static void permutationRanks(const StateBlock &block, int first, int n, uint16_t *ranks)
+	{
+		for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+			ranks[k] = 0;
+
+		for (int i = n - 1; i >= 1; i--)
+		{
+			for (int j = i - 1; j >= 0; j--)
+			{
+				const uint8_t *row = block.rows[first + i], *other = block.rows[first + j];
+
+				for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+					ranks[k] += row[k] < other[k];
+			}
+
+			for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+				ranks[k] *= i;
+		}
+	}
+
+	/**
+	 * Base-b number made of the rows first..first+n-1, the first row being the most significant.
+	 */
+	static void rowsInBase(const StateBlock &block, int first, int n, uint16_t base, uint8_t mask, uint16_t *values)
+	{
+		for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+			values[k] = 0;
+
+		for (int i = first; i < first + n; i++)
+		{
+			for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+				values[k] = values[k] * base + (block.rows[i][k] & mask);
+		}
+	}
+
+	/**
+	 * Metrics of a phase for every state of a block.
+	 * @param block - states to measure
+	 * @param phase - phase of the Thistlethwaite-Kociemba metrics
+	 * @param metrics - receives the metrics of every lane
+	 */
+	void metricsBlock(const StateBlock &block, unsigned int phase, MetricsBlock &metrics)
+	{
+		const int centers = 2 * TOTAL_NUM_CUBIES;
+		alignas(32) uint16_t sets[STATE_BLOCK_SIZE] = {};
+
+		if (phase == 0)
+		{
+			const uint16_t *ranks = getCombinationRanks();
+
+			rowsInBase(block, TOTAL_NUM_CUBIES + NUM_EDGES, NUM_CORNERS - 1, 3, 0xFF, metrics.m1);
+			rowsInBase(block, TOTAL_NUM_CUBIES, NUM_EDGES - 1, 2, 0xFF, metrics.m3);
+			rowsInBase(block, centers + 2, NUM_CENTERS - 2, 2, 0b1, metrics.m4);
+
+			for (int e = 0; e < NUM_EDGES; e++)
+			{
+				for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+					sets[k] |= uint16_t(block.rows[e][k] >= NUM_EDGES - NUM_MIDDLE_EDGES) << e;
+			}
+
+			for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+				metrics.m2[k] = ranks[sets[k]];
+		}
+		else if (phase == 1)
+		{
+			const uint16_t *ranks = getCombinationRanks();
+			const uint16_t *tetrads = getCornerTetrads();
+			alignas(32) uint16_t pairs[STATE_BLOCK_SIZE] = {};
+			alignas(32) uint8_t parity[STATE_BLOCK_SIZE] = {};
+
+			for (int e = 0; e < NUM_EDGES; e++)
+			{
+				for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+				{
+					uint8_t cubie = block.rows[e][k];
+					sets[k] |= uint16_t(cubie < NUM_EDGES - NUM_MIDDLE_EDGES && (cubie & 0b1)) << e;
+				}
+			}
+
+			for (int c = 0; c < NUM_CORNERS; c++)
+			{
+				for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+				{
+					uint8_t corner = block.rows[NUM_EDGES + c][k] - NUM_EDGES;
+					pairs[k] |= uint16_t((corner & 0b1) | (((corner >> 2) & 0b1) << 1)) << (2 * c);
+				}
+			}
+
+			for (int i = NUM_EDGES; i < TOTAL_NUM_CUBIES; i++)
+			{
+				for (int j = i + 1; j < TOTAL_NUM_CUBIES; j++)
+				{
+					for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+						parity[k] ^= block.rows[i][k] > block.rows[j][k];
+				}
+			}
+
+			for (unsigned int k = 0; k < STATE_BLOCK_SIZE; k++)
+			{
+				metrics.m1[k] = ranks[sets[k]];
+				metrics.m2[k] = tetrads[pairs[k]];
+				metrics.m3[k] = parity[k];
+				metrics.m4[k] = 0;
+			}
+		}
+		else
+		{
+			permutationRanks(block, NUM_EDGES, NUM_CORNERS, metrics.m1);
+			permutationRanks(block, 0, NUM_EDGES - NUM_MIDDLE_EDGES, metrics.m2);
+			permutationRanks(block, NUM_EDGES - NUM_MIDDLE_EDGES, NUM_MIDDLE_EDGES, metrics.m3);
+			rowsInBase(block, centers, 2, 2, 0b1, metrics.m4);
+		}
+	}
+
+	/**
+	 * Children of a block by one move with their metrics: the move is applied to every row,
+	 * then the metrics are read from the children while the block is still in the cache.
+	 */
+	void expandBlock(const StateBlock &parents, const Move &move, unsigned int phase, StateBlock &children,
+					 MetricsBlock &metrics)
+	{
+		applyMoveBlock(parents, move, children);
+		metricsBlock(children, phase, metrics);
+	}
+}
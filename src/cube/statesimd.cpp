@@ -0,0 +1,283 @@
+#include "cube/statesimd.h"
+#include "cube/coordinates.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RUBIK_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Compile a single function for an instruction set, MSVC allows the intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define RUBIK_TARGET(features) __attribute__((target(features)))
+#else
+#define RUBIK_TARGET(features)
+#endif
+
+namespace rubik
+{
+	StateKernels STATE_KERNELS = {nullptr, nullptr};
+	static SimdLevel SIMD_LEVEL = SimdLevel::SCALAR;
+
+#ifdef RUBIK_SIMD_X86
+	/*
+	A move on the three 16-byte lanes of the packed state. Lane 0 holds the
+	positions 0 to 15, lane 1 the positions 16 to 19 and the orientations of
+	the edges, lane 2 the orientations of the corners and the centers.
+	shuffle[in][out] picks the bytes of the output lane found in the input lane
+	(0x80 elsewhere, which pshufb turns into 0). A corner orientation never
+	comes from lanes 0 or 1, so lane 2 is only shuffled with itself.
+	*/
+	struct MoveShuffle
+	{
+		uint8_t shuffle[2][2][16];
+		uint8_t cornerShuffle[16];
+		// Added to the shuffled bytes
+		uint8_t delta[PACKED_STATE_SIZE];
+		// Subtracted once from the bytes reaching it, 0 for the bytes without a modulo
+		uint8_t modulo[PACKED_STATE_SIZE];
+		// Keeps the turns of the centers modulo 4
+		uint8_t mask[PACKED_STATE_SIZE];
+	};
+
+	static MoveShuffle MOVE_SHUFFLES[NUM_POSSIBLE_MOVES];
+
+	// Rank of every set of edge positions, see getCombinationRanks
+	static const uint16_t *COMBINATION_RANKS = nullptr;
+
+	static void buildMoveShuffles()
+	{
+		for (int m = 0; m < NUM_POSSIBLE_MOVES; m++)
+		{
+			Move move(m);
+			const MovePermutation &permutation = getMovePermutation(move);
+			MoveShuffle &shuffle = MOVE_SHUFFLES[m];
+
+			uint8_t source[PACKED_STATE_SIZE];
+			for (int i = 0; i < PACKED_STATE_SIZE; i++)
+			{
+				source[i] = i;
+				shuffle.delta[i] = 0;
+				shuffle.modulo[i] = 0;
+				shuffle.mask[i] = 0xFF;
+			}
+
+			for (int i = 0; i < TOTAL_NUM_CUBIES; i++)
+			{
+				source[i] = permutation.source[i];
+				source[i + TOTAL_NUM_CUBIES] = permutation.source[i] + TOTAL_NUM_CUBIES;
+				shuffle.delta[i + TOTAL_NUM_CUBIES] = permutation.orientation[i];
+				shuffle.modulo[i + TOTAL_NUM_CUBIES] = 2 + (i >= NUM_EDGES);
+			}
+
+			int center = 2 * TOTAL_NUM_CUBIES + move.getFace();
+			shuffle.delta[center] = move.getTurns();
+			shuffle.mask[center] = 0b11;
+
+			for (int in = 0; in < 2; in++)
+			{
+				for (int out = 0; out < 2; out++)
+				{
+					for (int k = 0; k < 16; k++)
+					{
+						int from = source[out * 16 + k];
+						shuffle.shuffle[in][out][k] = from / 16 == in ? from % 16 : 0x80;
+					}
+				}
+			}
+
+			for (int k = 0; k < 16; k++)
+				shuffle.cornerShuffle[k] = source[32 + k] - 32;
+		}
+
+		COMBINATION_RANKS = getCombinationRanks();
+	}
+
+	/**
+	 * Orientation change and modulo of a lane after the shuffle.
+	 */
+	RUBIK_TARGET("ssse3")
+	static inline __m128i orientLane(__m128i lane, const MoveShuffle &shuffle, int offset)
+	{
+		const __m128i *delta = reinterpret_cast<const __m128i *>(shuffle.delta + offset);
+		const __m128i *modulo = reinterpret_cast<const __m128i *>(shuffle.modulo + offset);
+		const __m128i *mask = reinterpret_cast<const __m128i *>(shuffle.mask + offset);
+
+		lane = _mm_add_epi8(lane, _mm_loadu_si128(delta));
+		lane = _mm_min_epu8(lane, _mm_sub_epi8(lane, _mm_loadu_si128(modulo)));
+		return _mm_and_si128(lane, _mm_loadu_si128(mask));
+	}
+
+	RUBIK_TARGET("ssse3")
+	static void applyMoveSsse3(uint8_t *state, uint8_t move)
+	{
+		const MoveShuffle &shuffle = MOVE_SHUFFLES[move];
+		const __m128i *lanes = reinterpret_cast<const __m128i *>(state);
+		const __m128i *masks = reinterpret_cast<const __m128i *>(shuffle.shuffle);
+
+		__m128i in0 = _mm_load_si128(lanes), in1 = _mm_load_si128(lanes + 1), in2 = _mm_load_si128(lanes + 2);
+
+		__m128i out0 = _mm_or_si128(_mm_shuffle_epi8(in0, _mm_loadu_si128(masks)),
+									_mm_shuffle_epi8(in1, _mm_loadu_si128(masks + 2)));
+		__m128i out1 = _mm_or_si128(_mm_shuffle_epi8(in0, _mm_loadu_si128(masks + 1)),
+									_mm_shuffle_epi8(in1, _mm_loadu_si128(masks + 3)));
+		__m128i out2 = _mm_shuffle_epi8(in2, _mm_loadu_si128(reinterpret_cast<const __m128i *>(shuffle.cornerShuffle)));
+
+		__m128i *result = reinterpret_cast<__m128i *>(state);
+		_mm_store_si128(result, orientLane(out0, shuffle, 0));
+		_mm_store_si128(result + 1, orientLane(out1, shuffle, 16));
+		_mm_store_si128(result + 2, orientLane(out2, shuffle, 32));
+	}
+
+	/**
+	 * Same as applyMoveSsse3 with the two first lanes in a single register: each input
+	 * lane is broadcast to both halves and shuffled into both output lanes at once.
+	 */
+	RUBIK_TARGET("avx2")
+	static void applyMoveAvx2(uint8_t *state, uint8_t move)
+	{
+		const MoveShuffle &shuffle = MOVE_SHUFFLES[move];
+		const __m256i *masks = reinterpret_cast<const __m256i *>(shuffle.shuffle);
+
+		__m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state));
+		__m256i in0 = _mm256_permute2x128_si256(low, low, 0x00);
+		__m256i in1 = _mm256_permute2x128_si256(low, low, 0x11);
+
+		__m256i out = _mm256_or_si256(_mm256_shuffle_epi8(in0, _mm256_loadu_si256(masks)),
+									  _mm256_shuffle_epi8(in1, _mm256_loadu_si256(masks + 1)));
+
+		out = _mm256_add_epi8(out, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(shuffle.delta)));
+		out = _mm256_min_epu8(out, _mm256_sub_epi8(out, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(shuffle.modulo))));
+		out = _mm256_and_si256(out, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(shuffle.mask)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(state), out);
+
+		__m128i *lanes = reinterpret_cast<__m128i *>(state);
+		__m128i corners = _mm_shuffle_epi8(_mm_load_si128(lanes + 2),
+										   _mm_loadu_si128(reinterpret_cast<const __m128i *>(shuffle.cornerShuffle)));
+		_mm_store_si128(lanes + 2, orientLane(corners, shuffle, 32));
+	}
+
+	/**
+	 * Metrics of the first phase from the lanes: the edge flip and the middle edges
+	 * are byte masks, the corner twist a multiply-add of the orientations.
+	 */
+	RUBIK_TARGET("ssse3")
+	static TKMetrics phase0MetricsSsse3(const uint8_t *state)
+	{
+		const __m128i *lanes = reinterpret_cast<const __m128i *>(state);
+		__m128i lane0 = _mm_load_si128(lanes), lane1 = _mm_load_si128(lanes + 1), lane2 = _mm_load_si128(lanes + 2);
+
+		// Flip of the edges 0 to 10, the first one being the highest bit
+		__m128i flips = _mm_shuffle_epi8(lane1, _mm_setr_epi8(14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, -128, -128, -128,
+															  -128, -128));
+		uint16_t flip = _mm_movemask_epi8(_mm_slli_epi16(flips, 7));
+
+		// Positions 0 to 11 holding a middle edge
+		__m128i middle = _mm_cmpgt_epi8(lane0, _mm_set1_epi8(NUM_EDGES - NUM_MIDDLE_EDGES - 1));
+		uint16_t slice = COMBINATION_RANKS[_mm_movemask_epi8(middle) & ((1 << NUM_EDGES) - 1)];
+
+		// Twist of the corners 0 to 6 in base 3: ((27 t0 + 9 t1) + (3 t2 + t3)) * 27 + (9 t4 + 3 t5) + t6
+		__m128i twists = _mm_maddubs_epi16(lane2, _mm_setr_epi8(27, 9, 3, 1, 9, 3, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+		uint16_t twist = (_mm_extract_epi16(twists, 0) + _mm_extract_epi16(twists, 1)) * 27 +
+						 _mm_extract_epi16(twists, 2) + _mm_extract_epi16(twists, 3);
+
+		uint16_t parity = 0;
+		for (int c = 2; c < NUM_CENTERS; c++)
+			parity = parity * 2 + (state[2 * TOTAL_NUM_CUBIES + c] & 0b1);
+
+		return TKMetrics{twist, slice, flip, parity};
+	}
+
+	static bool cpuSupports(SimdLevel level)
+	{
+		if (level == SimdLevel::SCALAR)
+			return true;
+
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_cpu_init();
+		return level == SimdLevel::SSSE3 ? __builtin_cpu_supports("ssse3") : __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		if (level == SimdLevel::SSSE3)
+			return (info[2] >> 9) & 1;
+
+		// AVX2 also needs the system to save the upper halves of the registers
+		bool osSaves = ((info[2] >> 27) & 1) && (_xgetbv(0) & 0b110) == 0b110;
+		__cpuidex(info, 7, 0);
+		return osSaves && ((info[1] >> 5) & 1);
+#else
+		return false;
+#endif
+	}
+#else
+	static bool cpuSupports(SimdLevel level)
+	{
+		return level == SimdLevel::SCALAR;
+	}
+#endif
+
+	/**
+	 * @return the widest instruction set of the CPU that has kernels
+	 */
+	SimdLevel detectSimdLevel()
+	{
+		if (cpuSupports(SimdLevel::AVX2))
+			return SimdLevel::AVX2;
+		if (cpuSupports(SimdLevel::SSSE3))
+			return SimdLevel::SSSE3;
+
+		return SimdLevel::SCALAR;
+	}
+
+	SimdLevel getSimdLevel()
+	{
+		return SIMD_LEVEL;
+	}
+
+	/**
+	 * Use the kernels of an instruction set. Must not be called while states are
+	 * being turned on other threads.
+	 * @param level - instruction set, SCALAR for the portable code
+	 * @return false if the CPU does not support it, the kernels are then unchanged
+	 */
+	bool setSimdLevel(SimdLevel level)
+	{
+		if (!cpuSupports(level))
+			return false;
+
+#ifdef RUBIK_SIMD_X86
+		static bool built = false;
+		if (!built && level != SimdLevel::SCALAR)
+		{
+			buildMoveShuffles();
+			built = true;
+		}
+
+		if (level == SimdLevel::AVX2)
+			STATE_KERNELS = StateKernels{applyMoveAvx2, phase0MetricsSsse3};
+		else if (level == SimdLevel::SSSE3)
+			STATE_KERNELS = StateKernels{applyMoveSsse3, phase0MetricsSsse3};
+		else
+			STATE_KERNELS = StateKernels{nullptr, nullptr};
+#endif
+
+		SIMD_LEVEL = level;
+		return true;
+	}
+
+	const char *simdLevelName(SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::SSSE3:
+			return "ssse3";
+		case SimdLevel::AVX2:
+			return "avx2";
+		default:
+			return "scalar";
+		}
+	}
+}
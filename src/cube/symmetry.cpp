@@ -0,0 +1,432 @@
+#include "cube/symmetry.h"
+#include "cube/coordinates.h"
+#include "cube/permutation.h"
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <vector>
+
+namespace rubik
+{
+	/*
+	Image of every face (U, D, F, B, L, R) under the four basic symmetries.
+	*/
+	static const uint8_t URF3_FACES[] = {5, 4, 0, 1, 3, 2};
+	static const uint8_t F2_FACES[] = {1, 0, 2, 3, 5, 4};
+	static const uint8_t U4_FACES[] = {0, 1, 5, 4, 2, 3};
+	static const uint8_t LR2_FACES[] = {0, 1, 2, 3, 5, 4};
+
+	/**
+	 * Find how a symmetry moves and reorients one kind of cubies, knowing only how it
+	 * maps the moves: S M S^-1 must be the image of M for all 18 moves. Once the image
+	 * of the first cubie is guessed, the moves give the image of all the others.
+	 * @param symmetry - symmetry whose moves are known
+	 * @param first - first position of the cubies (0 for edges, 12 for corners)
+	 * @param count - number of cubies
+	 * @param modulo - number of orientations of the cubies
+	 * @return whether a consistent solution was found
+	 */
+	static bool solveCubies(Symmetry &symmetry, int first, int count, int modulo)
+	{
+		const int sign = (symmetry.mirror && modulo == 3) ? modulo - 1 : 1;
+
+		for (int target = first; target < first + count; target++)
+		{
+			for (int delta = 0; delta < modulo; delta++)
+			{
+				bool assigned[TOTAL_NUM_CUBIES] = {};
+				int queue[TOTAL_NUM_CUBIES];
+				int head = 0, tail = 0;
+
+				symmetry.permutation[first] = target;
+				symmetry.orientation[first] = delta;
+				assigned[first] = true;
+				queue[tail++] = first;
+
+				bool consistent = true;
+
+				while (head < tail && consistent)
+				{
+					int i = queue[head++];
+
+					for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES && consistent; m++)
+					{
+						const MovePermutation &move = getMovePermutation(Move(m));
+						const MovePermutation &image = getMovePermutation(Move(symmetry.moves[m]));
+
+						int j = move.source[i];
+						int position = image.source[symmetry.permutation[i]];
+						int orientation = (image.orientation[symmetry.permutation[i]] + symmetry.orientation[i] +
+										   (modulo - sign) * move.orientation[i]) %
+										  modulo;
+
+						if (!assigned[j])
+						{
+							symmetry.permutation[j] = position;
+							symmetry.orientation[j] = orientation;
+							assigned[j] = true;
+							queue[tail++] = j;
+						}
+						else if (symmetry.permutation[j] != position || symmetry.orientation[j] != orientation)
+						{
+							consistent = false;
+						}
+					}
+				}
+
+				bool used[TOTAL_NUM_CUBIES] = {};
+				for (int i = first; i < first + count && consistent; i++)
+				{
+					consistent = !used[symmetry.permutation[i]];
+					used[symmetry.permutation[i]] = true;
+				}
+
+				if (consistent && tail == count)
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	static std::array<Symmetry, NUM_SYMMETRIES> buildSymmetries()
+	{
+		std::array<Symmetry, NUM_SYMMETRIES> symmetries;
+
+		for (unsigned int s = 0; s < NUM_SYMMETRIES; s++)
+		{
+			Symmetry &symmetry = symmetries[s];
+			symmetry.mirror = s % 2;
+
+			for (int face = 0; face < NUM_CENTERS; face++)
+			{
+				int image = face;
+
+				for (unsigned int i = 0; i < s % 2; i++)
+					image = LR2_FACES[image];
+				for (unsigned int i = 0; i < (s / 2) % 4; i++)
+					image = U4_FACES[image];
+				for (unsigned int i = 0; i < (s / 8) % 2; i++)
+					image = F2_FACES[image];
+				for (unsigned int i = 0; i < s / 16; i++)
+					image = URF3_FACES[image];
+
+				symmetry.faces[face] = image;
+			}
+
+			for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES; m++)
+			{
+				Move move(m);
+				int turns = symmetry.mirror ? 4 - move.getTurns() : move.getTurns();
+				symmetry.moves[m] = Move(symmetry.faces[move.getFace()], turns).code();
+			}
+
+			if (!solveCubies(symmetry, 0, NUM_EDGES, 2) || !solveCubies(symmetry, NUM_EDGES, NUM_CORNERS, 3))
+				std::cerr << "ERROR: The symmetry " << s << " does not match the cubies." << std::endl;
+		}
+
+		// The symmetries are told apart by their effect on the faces
+		for (unsigned int s = 0; s < NUM_SYMMETRIES; s++)
+		{
+			for (unsigned int t = 0; t < NUM_SYMMETRIES; t++)
+			{
+				bool identity = true;
+				for (int face = 0; face < NUM_CENTERS; face++)
+					identity &= symmetries[t].faces[symmetries[s].faces[face]] == face;
+
+				if (identity)
+					symmetries[s].inverse = t;
+			}
+		}
+
+		return symmetries;
+	}
+
+	/**
+	 * @param symmetry - index of the symmetry
+	 */
+	const Symmetry &getSymmetry(unsigned int symmetry)
+	{
+		// Built on first use, the move permutations are static too
+		static const std::array<Symmetry, NUM_SYMMETRIES> symmetries = buildSymmetries();
+		return symmetries[symmetry];
+	}
+
+	/**
+	 * Conjugate a state by a symmetry: the same state seen in a rotated (or mirrored) cube.
+	 * @param state - state to conjugate
+	 * @param symmetry - index of the symmetry
+	 */
+	CubeState conjugate(const CubeState &state, unsigned int symmetry)
+	{
+		const Symmetry &s = getSymmetry(symmetry);
+		std::array<uint8_t, PACKED_STATE_SIZE> result{};
+
+		for (int i = 0; i < TOTAL_NUM_CUBIES; i++)
+		{
+			int modulo = 2 + (i >= NUM_EDGES);
+			int cubie = state[i];
+			int orientation = state[i + TOTAL_NUM_CUBIES];
+
+			if (s.mirror && modulo == 3)
+				orientation = (3 - orientation) % 3;
+
+			result[s.permutation[i]] = s.permutation[cubie];
+			result[s.permutation[i] + TOTAL_NUM_CUBIES] = (orientation + s.orientation[cubie] + modulo - s.orientation[i]) % modulo;
+		}
+
+		for (int face = 0; face < NUM_CENTERS; face++)
+		{
+			int turns = state[2 * TOTAL_NUM_CUBIES + face];
+			result[2 * TOTAL_NUM_CUBIES + s.faces[face]] = s.mirror ? (4 - turns) & 0b11 : turns;
+		}
+
+		return CubeState(result);
+	}
+
+	/**
+	 * @param move - move to conjugate
+	 * @param symmetry - index of the symmetry
+	 * @return the move turning the same face of the rotated (or mirrored) cube
+	 */
+	Move conjugate(const Move &move, unsigned int symmetry)
+	{
+		return Move(int(getSymmetry(symmetry).moves[move.code()]));
+	}
+
+	/**
+	 * Build a state with the given edge flip and slice combination, other cubies solved.
+	 */
+	static CubeState flipSliceState(uint16_t flip, uint16_t slice)
+	{
+		std::array<uint8_t, PACKED_STATE_SIZE> cubies{};
+		uint32_t marked = combinationUnrank(slice, NUM_MIDDLE_EDGES);
+
+		int middle = NUM_EDGES - NUM_MIDDLE_EDGES, other = 0, parity = 0;
+		for (int e = 0; e < NUM_EDGES; e++)
+		{
+			cubies[e] = (marked >> e) & 1 ? middle++ : other++;
+
+			if (e < NUM_EDGES - 1)
+			{
+				cubies[e + TOTAL_NUM_CUBIES] = (flip >> (NUM_EDGES - 2 - e)) & 1;
+				parity ^= cubies[e + TOTAL_NUM_CUBIES];
+			}
+		}
+		cubies[NUM_EDGES - 1 + TOTAL_NUM_CUBIES] = parity;
+
+		for (int c = NUM_EDGES; c < TOTAL_NUM_CUBIES; c++)
+			cubies[c] = c;
+
+		return CubeState(cubies);
+	}
+
+	/**
+	 * Build a state with the given corner permutation, other cubies solved.
+	 */
+	static CubeState cornerPermutationState(uint16_t corners)
+	{
+		std::array<uint8_t, PACKED_STATE_SIZE> cubies{};
+
+		for (int i = 0; i < NUM_EDGES; i++)
+			cubies[i] = i;
+		permutationUnrank(corners, NUM_CORNERS, NUM_EDGES, cubies.data() + NUM_EDGES);
+
+		return CubeState(cubies);
+	}
+
+	/**
+	 * Build a state with the given corner twist, other cubies solved.
+	 */
+	static CubeState twistState(uint16_t twist)
+	{
+		std::array<uint8_t, PACKED_STATE_SIZE> cubies{};
+		int sum = 0;
+
+		for (int i = 0; i < TOTAL_NUM_CUBIES; i++)
+			cubies[i] = i;
+
+		for (int c = NUM_CORNERS - 2; c >= 0; c--)
+		{
+			cubies[TOTAL_NUM_CUBIES + NUM_EDGES + c] = twist % 3;
+			sum += twist % 3;
+			twist /= 3;
+		}
+		cubies[TOTAL_NUM_CUBIES + TOTAL_NUM_CUBIES - 1] = (3 - sum % 3) % 3;
+
+		return CubeState(cubies);
+	}
+
+	template <typename T>
+	static std::vector<uint8_t> tableBytes(const std::vector<T> &table)
+	{
+		const uint8_t *raw = reinterpret_cast<const uint8_t *>(table.data());
+		return std::vector<uint8_t>(raw, raw + table.size() * sizeof(T));
+	}
+
+	/**
+	 * Sort raw coordinates into symmetry classes. The smallest raw value of a class is
+	 * its representative and the other values are found by conjugating it.
+	 * @param size - number of raw values
+	 * @param classCount - expected number of classes
+	 * @param stateOf - builds a state with a given raw value
+	 * @param valueOf - raw value of a state
+	 * @param classes - receives class | symmetry << 16 for every raw value
+	 * @param representatives - receives the raw representative of every class
+	 */
+	template <typename StateOf, typename ValueOf>
+	static void buildClasses(uint32_t size, uint32_t classCount, StateOf stateOf, ValueOf valueOf,
+							 std::vector<uint32_t> &classes, std::vector<uint32_t> &representatives)
+	{
+		const uint32_t UNASSIGNED = 0xFFFFFFFF;
+
+		classes.assign(size, UNASSIGNED);
+		representatives.clear();
+
+		for (uint32_t raw = 0; raw < size; raw++)
+		{
+			if (classes[raw] != UNASSIGNED)
+				continue;
+
+			if (representatives.size() == classCount)
+			{
+				std::cerr << "ERROR: More than " << classCount << " symmetry classes were found." << std::endl;
+				return;
+			}
+
+			uint32_t index = representatives.size();
+			representatives.push_back(raw);
+
+			CubeState representative = stateOf(raw);
+
+			for (uint32_t s = 0; s < NUM_UD_SYMMETRIES; s++)
+			{
+				uint32_t image = valueOf(conjugate(representative, s));
+
+				if (classes[image] == UNASSIGNED)
+					classes[image] = index | (s << 16);
+			}
+		}
+	}
+
+	SymmetryTables::SymmetryTables()
+	{
+		std::vector<uint32_t> flipSliceClasses, flipSliceRepresentatives;
+		auto buildFlipSlice = [&]()
+		{
+			if (flipSliceRepresentatives.empty())
+				buildClasses(
+					FLIP_SLICE_SIZE, FLIP_SLICE_CLASSES,
+					[](uint32_t raw)
+					{ return flipSliceState(raw % 2048, raw / 2048); },
+					[](const CubeState &state)
+					{ return uint32_t(sliceCombination(state)) * 2048 + edgeFlip(state); },
+					flipSliceClasses, flipSliceRepresentatives);
+		};
+
+		std::vector<uint32_t> cornerClasses, cornerRepresentatives;
+		auto buildCorners = [&]()
+		{
+			if (cornerRepresentatives.empty())
+				buildClasses(
+					COORDINATE_SIZES[CORNER_PERMUTATION], CORNER_PERMUTATION_CLASSES,
+					[](uint32_t raw)
+					{ return cornerPermutationState(raw); },
+					[](const CubeState &state)
+					{ return uint32_t(cornerPermutation(state)); },
+					cornerClasses, cornerRepresentatives);
+		};
+
+		_files[0] = loadOrBuildTable("sym_flip_slice_class", FLIP_SLICE_SIZE * sizeof(uint32_t), [&]()
+									 { buildFlipSlice(); return tableBytes(flipSliceClasses); });
+		_files[1] = loadOrBuildTable("sym_flip_slice_representative", FLIP_SLICE_CLASSES * sizeof(uint32_t), [&]()
+									 { buildFlipSlice(); flipSliceRepresentatives.resize(FLIP_SLICE_CLASSES);
+									   return tableBytes(flipSliceRepresentatives); });
+		_files[2] = loadOrBuildTable("sym_corner_class", COORDINATE_SIZES[CORNER_PERMUTATION] * sizeof(uint32_t), [&]()
+									 { buildCorners(); return tableBytes(cornerClasses); });
+		_files[3] = loadOrBuildTable("sym_corner_representative", CORNER_PERMUTATION_CLASSES * sizeof(uint16_t), [&]()
+									 {
+			buildCorners();
+			std::vector<uint16_t> representatives(cornerRepresentatives.begin(), cornerRepresentatives.end());
+			representatives.resize(CORNER_PERMUTATION_CLASSES);
+			return tableBytes(representatives); });
+		_files[4] = loadOrBuildTable("sym_twist_conjugate", COORDINATE_SIZES[CORNER_TWIST] * NUM_UD_SYMMETRIES * sizeof(uint16_t), [&]()
+									 {
+			std::vector<uint16_t> conjugates(COORDINATE_SIZES[CORNER_TWIST] * NUM_UD_SYMMETRIES);
+			for (uint16_t twist = 0; twist < COORDINATE_SIZES[CORNER_TWIST]; twist++)
+			{
+				CubeState state = twistState(twist);
+				for (unsigned int s = 0; s < NUM_UD_SYMMETRIES; s++)
+					conjugates[twist * NUM_UD_SYMMETRIES + s] = cornerTwist(conjugate(state, s));
+			}
+			return tableBytes(conjugates); });
+
+		_flipSliceClass = reinterpret_cast<const uint32_t *>(_files[0].data());
+		_flipSliceRepresentative = reinterpret_cast<const uint32_t *>(_files[1].data());
+		_cornerClass = reinterpret_cast<const uint32_t *>(_files[2].data());
+		_cornerRepresentative = reinterpret_cast<const uint16_t *>(_files[3].data());
+		_twistConjugate = reinterpret_cast<const uint16_t *>(_files[4].data());
+	}
+
+	/**
+	 * Access the tables, building them on the first call.
+	 */
+	const SymmetryTables &SymmetryTables::getInstance()
+	{
+		static const SymmetryTables instance;
+		return instance;
+	}
+
+	/**
+	 * @return size of the class tables
+	 */
+	size_t SymmetryTables::bytes() const
+	{
+		size_t total = 0;
+		for (const MappedTable &file : _files)
+			total += file.size();
+
+		return total;
+	}
+
+	/**
+	 * Show how much memory the symmetry classes save on the tables they index,
+	 * at one byte per entry.
+	 * @param s - stream to write to
+	 */
+	void printSymmetryFootprint(std::ostream &s)
+	{
+		struct Footprint
+		{
+			const char *name;
+			uint64_t raw;
+			uint64_t reduced;
+		};
+
+		const uint64_t twist = COORDINATE_SIZES[CORNER_TWIST];
+		const uint64_t corners = COORDINATE_SIZES[CORNER_PERMUTATION];
+		const uint64_t edges = COORDINATE_SIZES[EDGE_PERMUTATION];
+		const uint64_t slice = COORDINATE_SIZES[SLICE_PERMUTATION];
+
+		const Footprint footprints[] = {
+			{"flip x slice", FLIP_SLICE_SIZE, FLIP_SLICE_CLASSES},
+			{"corner permutation", corners, CORNER_PERMUTATION_CLASSES},
+			{"twist x flip x slice", twist * FLIP_SLICE_SIZE, twist * FLIP_SLICE_CLASSES},
+			{"corner permutation x slice", corners * slice, CORNER_PERMUTATION_CLASSES * slice},
+			{"corner permutation x edge permutation", corners * edges, CORNER_PERMUTATION_CLASSES * edges},
+		};
+
+		s << std::left << std::setw(40) << "Table" << std::right << std::setw(16) << "Raw bytes"
+		  << std::setw(16) << "Symmetric bytes" << std::setw(8) << "Ratio" << std::endl;
+
+		for (const Footprint &footprint : footprints)
+		{
+			s << std::left << std::setw(40) << footprint.name << std::right << std::setw(16) << footprint.raw
+			  << std::setw(16) << footprint.reduced << std::setw(8) << std::fixed << std::setprecision(1)
+			  << double(footprint.raw) / footprint.reduced << std::endl;
+		}
+
+		s << "Symmetry class tables: " << SymmetryTables::getInstance().bytes() << " bytes" << std::endl;
+	}
+}
@@ -0,0 +1,366 @@
+#include "cube/tablefile.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace rubik
+{
+	static TableFileOptions TABLE_OPTIONS;
+	static std::vector<TableLoadReport> TABLE_REPORTS;
+	static std::mutex TABLE_MUTEX;
+
+	void setTableFileOptions(const TableFileOptions &options)
+	{
+		std::lock_guard<std::mutex> lock(TABLE_MUTEX);
+		TABLE_OPTIONS = options;
+	}
+
+	const TableFileOptions &getTableFileOptions()
+	{
+		return TABLE_OPTIONS;
+	}
+
+	/**
+	 * @return the directory of the table files, in order of priority: the options,
+	 * the RUBIK_TABLE_DIR environment variable and the res/Tables folder.
+	 */
+	std::string getTableDirectory()
+	{
+		if (!TABLE_OPTIONS.directory.empty())
+			return TABLE_OPTIONS.directory;
+
+		const char *environment = std::getenv("RUBIK_TABLE_DIR");
+		if (environment != nullptr && environment[0] != '\0')
+			return std::string(environment);
+
+		return std::string(DIRECTORY_PATH) + "/res/Tables";
+	}
+
+	/**
+	 * @return how every table of the process was obtained so far. The solvers never print
+	 * it, the front ends decide whether to show it.
+	 */
+	std::vector<TableLoadReport> getTableLoadReports()
+	{
+		std::lock_guard<std::mutex> lock(TABLE_MUTEX);
+		return TABLE_REPORTS;
+	}
+
+	/**
+	 * Show how long the tables took to map from their files, separately from
+	 * how long the missing ones took to generate.
+	 * @param s - stream to print to
+	 */
+	void printTableLoadSummary(std::ostream &s)
+	{
+		std::vector<TableLoadReport> reports = getTableLoadReports();
+
+		int loaded = 0, generated = 0;
+		double loadSeconds = 0.0, generationSeconds = 0.0;
+		size_t bytes = 0;
+
+		for (const TableLoadReport &report : reports)
+		{
+			loaded += report.fromFile;
+			generated += !report.fromFile;
+			loadSeconds += report.loadSeconds;
+			generationSeconds += report.generationSeconds;
+			bytes += report.bytes;
+		}
+
+		s << "Tables: " << loaded << " mapped in " << loadSeconds << " seconds, "
+		  << generated << " generated in " << generationSeconds << " seconds ("
+		  << bytes / (1024 * 1024) << " MB)" << std::endl;
+	}
+
+	/**
+	 * FNV-1a over 64-bit words, then over the remaining bytes.
+	 * @param data - entries of the table
+	 * @param size - number of bytes
+	 */
+	uint64_t tableChecksum(const uint8_t *data, size_t size)
+	{
+		const uint64_t prime = 0x100000001b3ULL;
+		uint64_t checksum = 0xcbf29ce484222325ULL;
+
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, data + i, 8);
+			checksum = (checksum ^ word) * prime;
+		}
+		for (; i < size; i++)
+		{
+			checksum = (checksum ^ data[i]) * prime;
+		}
+
+		return checksum;
+	}
+
+	static TableFileHeader makeHeader(const std::string &name, const uint8_t *data, size_t size)
+	{
+		TableFileHeader header{};
+		std::memcpy(header.magic, "RBKT", 4);
+		header.version = TABLE_FILE_VERSION;
+		std::strncpy(header.name, name.c_str(), TABLE_NAME_LENGTH - 1);
+		header.size = size;
+		header.checksum = tableChecksum(data, size);
+		return header;
+	}
+
+	static bool validHeader(const TableFileHeader &header, const std::string &name, size_t expectedSize)
+	{
+		return std::memcmp(header.magic, "RBKT", 4) == 0 &&
+			   header.version == TABLE_FILE_VERSION &&
+			   std::strncmp(header.name, name.c_str(), TABLE_NAME_LENGTH - 1) == 0 &&
+			   header.size == expectedSize;
+	}
+
+	MappedTable::MappedTable() : _data(nullptr), _size(0), _mapping(nullptr), _mappingSize(0) {}
+
+	MappedTable::MappedTable(MappedTable &&other) noexcept : MappedTable()
+	{
+		*this = std::move(other);
+	}
+
+	MappedTable &MappedTable::operator=(MappedTable &&other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+
+			_memory = std::move(other._memory);
+			_mapping = other._mapping;
+			_mappingSize = other._mappingSize;
+			_size = other._size;
+			_data = _mapping != nullptr ? other._data : _memory.data();
+
+			other._data = nullptr;
+			other._size = 0;
+			other._mapping = nullptr;
+			other._mappingSize = 0;
+		}
+
+		return *this;
+	}
+
+	MappedTable::~MappedTable()
+	{
+		release();
+	}
+
+	void MappedTable::release()
+	{
+#ifndef _WIN32
+		if (_mapping != nullptr)
+			munmap(_mapping, _mappingSize);
+#endif
+		_mapping = nullptr;
+		_mappingSize = 0;
+		_memory.clear();
+		_data = nullptr;
+		_size = 0;
+	}
+
+	/**
+	 * Map a table file read-only. Fails if the file is missing, from another version,
+	 * of the wrong size or corrupted.
+	 * @param path - file to map
+	 * @param name - expected name of the table
+	 * @param expectedSize - expected number of bytes of entries, 0 for any size
+	 */
+	bool MappedTable::map(const std::string &path, const std::string &name, size_t expectedSize)
+	{
+		release();
+
+		uint64_t storedChecksum = 0;
+
+#ifdef _WIN32
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		TableFileHeader header;
+		if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+			return false;
+
+		if (expectedSize == 0)
+			expectedSize = header.size;
+
+		if (!validHeader(header, name, expectedSize))
+			return false;
+
+		_memory.resize(expectedSize);
+		if (!file.read(reinterpret_cast<char *>(_memory.data()), expectedSize))
+		{
+			_memory.clear();
+			return false;
+		}
+
+		_data = _memory.data();
+		_size = expectedSize;
+		storedChecksum = header.checksum;
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		struct stat info;
+		bool sized = fstat(fd, &info) == 0;
+		if (sized && expectedSize == 0 && size_t(info.st_size) > sizeof(TableFileHeader))
+			expectedSize = info.st_size - sizeof(TableFileHeader);
+
+		if (!sized || size_t(info.st_size) != sizeof(TableFileHeader) + expectedSize)
+		{
+			close(fd);
+			return false;
+		}
+
+		int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+		if (TABLE_OPTIONS.populate)
+			flags |= MAP_POPULATE;
+#endif
+
+		void *mapping = mmap(nullptr, info.st_size, PROT_READ, flags, fd, 0);
+		close(fd);
+
+		if (mapping == MAP_FAILED)
+			return false;
+
+#ifdef MADV_HUGEPAGE
+		if (TABLE_OPTIONS.hugePages)
+			madvise(mapping, info.st_size, MADV_HUGEPAGE);
+#endif
+
+		_mapping = mapping;
+		_mappingSize = info.st_size;
+
+		const TableFileHeader *header = static_cast<const TableFileHeader *>(mapping);
+		if (!validHeader(*header, name, expectedSize))
+		{
+			release();
+			return false;
+		}
+
+		_data = static_cast<const uint8_t *>(mapping) + sizeof(TableFileHeader);
+		_size = expectedSize;
+		storedChecksum = header->checksum;
+#endif
+
+		if (tableChecksum(_data, _size) != storedChecksum)
+		{
+			std::cerr << "ERROR: The table file " << path << " is corrupted and will be generated again." << std::endl;
+			release();
+			return false;
+		}
+
+		return true;
+	}
+
+	/**
+	 * Keep a generated table in memory.
+	 */
+	void MappedTable::adopt(std::vector<uint8_t> &&memory)
+	{
+		release();
+		_memory = std::move(memory);
+		_data = _memory.data();
+		_size = _memory.size();
+	}
+
+	/**
+	 * Write a table file. The file is written next to its destination then renamed,
+	 * so concurrent processes never map a partial file.
+	 * @param path - destination of the file
+	 * @param name - name of the table
+	 * @param data - entries
+	 * @param size - number of bytes of entries
+	 */
+	bool saveTable(const std::string &path, const std::string &name, const uint8_t *data, size_t size)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+		// The thread id alone repeats from one process to the next, the process id tells them apart
+		std::string temporary = path + ".tmp" + std::to_string(getpid()) + "_" +
+								std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+		std::ofstream file(temporary, std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cerr << "ERROR: The table file " << path << " cannot be written." << std::endl;
+			return false;
+		}
+
+		TableFileHeader header = makeHeader(name, data, size);
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char *>(data), size);
+		file.close();
+
+		if (!file)
+		{
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+
+		std::filesystem::rename(temporary, path, error);
+		return !error;
+	}
+
+	/**
+	 * Map a table from its file, or generate it and save it for the next processes.
+	 * The time spent is kept in the load reports.
+	 * @param name - name of the table, also the name of its file
+	 * @param expectedSize - number of bytes of entries, 0 when only known once built
+	 * @param build - generator of the entries
+	 */
+	MappedTable loadOrBuildTable(const std::string &name, size_t expectedSize,
+								 const std::function<std::vector<uint8_t>()> &build)
+	{
+		std::string path = getTableDirectory() + "/" + name + ".table";
+
+		TableLoadReport report{name, expectedSize, false, 0.0, 0.0};
+		MappedTable table;
+
+		auto start = std::chrono::steady_clock::now();
+		report.fromFile = table.map(path, name, expectedSize);
+		report.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (!report.fromFile)
+		{
+			start = std::chrono::steady_clock::now();
+			std::vector<uint8_t> entries = build();
+			report.generationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			report.loadSeconds = 0.0;
+
+			if (TABLE_OPTIONS.persist)
+				saveTable(path, name, entries.data(), entries.size());
+
+			table.adopt(std::move(entries));
+		}
+
+		report.bytes = table.size();
+
+		std::lock_guard<std::mutex> lock(TABLE_MUTEX);
+		TABLE_REPORTS.push_back(report);
+
+		return table;
+	}
+}
@@ -0,0 +1,341 @@
+#include "cube/thistlethwaite.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+
+#include "cube/permutation.h"
+
+namespace rubik
+{
+	/**
+	 * Values of a coordinate reachable from the solved state with the given moves,
+	 * numbered in the order the breadth-first search finds them.
+	 * @param coordinate - coordinate to explore
+	 * @param legalMoves - moves allowed
+	 * @param index - receives the number of every value, INVALID_COORDINATE when unreachable
+	 * @param values - receives the value of every number
+	 */
+	static void numberReachable(Coordinate coordinate, unsigned int legalMoves, std::vector<uint16_t> &index,
+								std::vector<uint16_t> &values)
+	{
+		const MoveTables &moveTables = MoveTables::getInstance();
+
+		index.assign(COORDINATE_SIZES[coordinate], INVALID_COORDINATE);
+		values.assign(1, computeCoordinate(coordinate, CubeState()));
+		index[values[0]] = 0;
+
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES; m++)
+			{
+				if (!(legalMoves & (1 << m)))
+					continue;
+
+				uint16_t child = moveTables.apply(coordinate, values[i], Move(m));
+				if (index[child] == INVALID_COORDINATE)
+				{
+					index[child] = values.size();
+					values.push_back(child);
+				}
+			}
+		}
+	}
+
+	ThistlethwaiteTables::ThistlethwaiteTables()
+	{
+		MoveTables::getInstance();
+
+		numberReachable(CORNER_PERMUTATION, THISTLETHWAITE_GROUP_MOVES[3], _cornerIndex, _cornerValue);
+		numberReachable(EDGE_PERMUTATION, THISTLETHWAITE_GROUP_MOVES[3], _edgeIndex, _edgeValue);
+
+		// A state followed by the same moves stays as far from the goal group whatever half
+		// turns were made before it, so the corner permutations h * p with h among the
+		// permutations of the half turns share their distance: relabeling the cubies of p.
+		std::vector<std::array<uint8_t, NUM_CORNERS>> halfTurns(_cornerValue.size());
+		for (size_t h = 0; h < halfTurns.size(); h++)
+			permutationUnrank(_cornerValue[h], NUM_CORNERS, 0, halfTurns[h].data());
+
+		const uint32_t permutations = COORDINATE_SIZES[CORNER_PERMUTATION];
+		_cornerCoset.assign(permutations, INVALID_COORDINATE);
+		_cosetCorners.clear();
+
+		for (uint32_t p = 0; p < permutations; p++)
+		{
+			if (_cornerCoset[p] != INVALID_COORDINATE)
+				continue;
+
+			uint8_t corners[NUM_CORNERS], relabeled[NUM_CORNERS];
+			permutationUnrank(p, NUM_CORNERS, 0, corners);
+
+			for (const std::array<uint8_t, NUM_CORNERS> &h : halfTurns)
+			{
+				for (unsigned int c = 0; c < NUM_CORNERS; c++)
+					relabeled[c] = h[corners[c]];
+
+				_cornerCoset[permutationRank(relabeled, NUM_CORNERS)] = _cosetCorners.size();
+			}
+
+			_cosetCorners.push_back(p);
+		}
+
+		// Combinations of 4 edges out of the middle slice (positions 8 to 11)
+		_tetradIndex.assign(COORDINATE_SIZES[EDGE_TETRAD], INVALID_COORDINATE);
+		_tetradValue.clear();
+		for (uint16_t t = 0; t < COORDINATE_SIZES[EDGE_TETRAD]; t++)
+		{
+			if ((combinationUnrank(t, 4) >> (NUM_EDGES - NUM_MIDDLE_EDGES)) == 0)
+			{
+				_tetradIndex[t] = _tetradValue.size();
+				_tetradValue.push_back(t);
+			}
+		}
+
+		uint8_t count[2] = {0, 0};
+		for (uint8_t s = 0; s < COORDINATE_SIZES[SLICE_PERMUTATION]; s++)
+		{
+			uint8_t slice[NUM_MIDDLE_EDGES];
+			permutationUnrank(s, NUM_MIDDLE_EDGES, 0, slice);
+
+			uint16_t parity = permutationParity(slice, NUM_MIDDLE_EDGES);
+			_sliceIndex[s] = count[parity]++;
+			_sliceValue[parity][_sliceIndex[s]] = s;
+		}
+
+		for (unsigned int phase = 0; phase < THISTLETHWAITE_PHASE_COUNT; phase++)
+		{
+			_files[phase] = loadOrBuildTable("distance_thistlethwaite_" + std::to_string(phase + 1),
+											 (THISTLETHWAITE_PHASE_SIZES[phase] + 3) / 4, [=, this]()
+											 { return buildDistanceTable(phase); });
+			_distances[phase] = _files[phase].data();
+		}
+	}
+
+	/**
+	 * Access the tables, building them on the first call.
+	 */
+	const ThistlethwaiteTables &ThistlethwaiteTables::getInstance()
+	{
+		static const ThistlethwaiteTables instance;
+		return instance;
+	}
+
+	/**
+	 * Entry of a state in the distance table of a phase.
+	 * @param phase - phase of the table
+	 * @param values - coordinates of the phase (see THISTLETHWAITE_COORDINATES)
+	 */
+	uint32_t ThistlethwaiteTables::index(unsigned int phase, const uint16_t *values) const
+	{
+		switch (phase)
+		{
+		case 0:
+			return values[0];
+		case 1:
+			return uint32_t(values[0]) * COORDINATE_SIZES[SLICE_COMBINATION] + values[1];
+		case 2:
+			return uint32_t(_cornerCoset[values[0]]) * _tetradValue.size() + _tetradIndex[values[1]];
+		default:
+			// The parity of the middle slice follows the one of the other edges
+			return (uint32_t(_cornerIndex[values[0]]) * _edgeValue.size() + _edgeIndex[values[1]]) * 12 +
+				   _sliceIndex[values[2]];
+		}
+	}
+
+	/**
+	 * Coordinates of a state of the entry of a distance table, the inverse of index.
+	 */
+	void ThistlethwaiteTables::values(unsigned int phase, uint32_t index, uint16_t *values) const
+	{
+		switch (phase)
+		{
+		case 0:
+			values[0] = index;
+			break;
+		case 1:
+			values[0] = index / COORDINATE_SIZES[SLICE_COMBINATION];
+			values[1] = index % COORDINATE_SIZES[SLICE_COMBINATION];
+			break;
+		case 2:
+			values[0] = _cosetCorners[index / _tetradValue.size()];
+			values[1] = _tetradValue[index % _tetradValue.size()];
+			break;
+		default:
+		{
+			uint8_t edges[NUM_EDGES - NUM_MIDDLE_EDGES];
+			values[0] = _cornerValue[index / 12 / _edgeValue.size()];
+			values[1] = _edgeValue[index / 12 % _edgeValue.size()];
+			permutationUnrank(values[1], NUM_EDGES - NUM_MIDDLE_EDGES, 0, edges);
+			values[2] = _sliceValue[permutationParity(edges, NUM_EDGES - NUM_MIDDLE_EDGES)][index % 12];
+		}
+		}
+	}
+
+	/**
+	 * Breadth-first search of the cosets of a phase from the goal group, storing the
+	 * depths modulo 3.
+	 */
+	std::vector<uint8_t> ThistlethwaiteTables::buildDistanceTable(unsigned int phase) const
+	{
+		const MoveTables &moveTables = MoveTables::getInstance();
+		const Coordinate *coordinates = THISTLETHWAITE_COORDINATES[phase];
+
+		std::vector<uint8_t> table((THISTLETHWAITE_PHASE_SIZES[phase] + 3) / 4, 0xFF);
+		auto set = [&](uint32_t index, uint8_t distance)
+		{
+			uint8_t shift = (index & 3) * 2;
+			table[index >> 2] = (table[index >> 2] & ~(0b11 << shift)) | (distance << shift);
+		};
+		auto get = [&](uint32_t index)
+		{
+			return (table[index >> 2] >> ((index & 3) * 2)) & 0b11;
+		};
+
+		uint16_t values[3], child[3];
+		for (unsigned int c = 0; c < 3 && coordinates[c] != COORDINATE_COUNT; c++)
+			values[c] = computeCoordinate(coordinates[c], CubeState());
+
+		uint32_t start = index(phase, values);
+		std::vector<uint32_t> frontier(1, start);
+		std::vector<uint32_t> next;
+		set(start, 0);
+
+		for (uint8_t depth = 0; !frontier.empty(); depth++)
+		{
+			next.clear();
+
+			for (uint32_t parent : frontier)
+			{
+				this->values(phase, parent, values);
+
+				for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES; m++)
+				{
+					if (!(THISTLETHWAITE_GROUP_MOVES[phase] & (1 << m)))
+						continue;
+
+					for (unsigned int c = 0; c < 3 && coordinates[c] != COORDINATE_COUNT; c++)
+						child[c] = moveTables.apply(coordinates[c], values[c], Move(m));
+
+					uint32_t childIndex = index(phase, child);
+					if (get(childIndex) == UNREACHED_DISTANCE)
+					{
+						set(childIndex, (depth + 1) % 3);
+						next.push_back(childIndex);
+					}
+				}
+			}
+
+			std::swap(frontier, next);
+		}
+
+		return table;
+	}
+
+	/**
+	 * Compute an algorithm to solve the current scrambled state of the cube with the
+	 * four phases of Thistlethwaite's algorithm, without any search: every move is the
+	 * first one of the phase that brings the cube closer to the next group according to
+	 * the distance tables. Averages around 31 moves (45 at most) in a few microseconds. The
+	 * orientation of the centers is not considered.
+	 * @param problem - state of the cube to solve
+	 * @param report - filled with the time, table lookups and moves of each phase if given
+	 */
+	std::queue<Move> thistlethwaite(CubeState problem, SolveReport *report)
+	{
+		const ThistlethwaiteTables &tables = ThistlethwaiteTables::getInstance();
+		const MoveTables &moveTables = MoveTables::getInstance();
+
+		auto start = std::chrono::steady_clock::now();
+		auto phaseStart = start;
+
+		std::vector<Move> algorithm;
+		std::vector<PhaseReport> phases(THISTLETHWAITE_PHASE_COUNT);
+		bool found = true;
+
+		for (unsigned int phase = 0; phase < THISTLETHWAITE_PHASE_COUNT && found; phase++)
+		{
+			const Coordinate *coordinates = THISTLETHWAITE_COORDINATES[phase];
+			unsigned int count = 0;
+			uint16_t values[3], child[3];
+
+			while (count < 3 && coordinates[count] != COORDINATE_COUNT)
+			{
+				values[count] = computeCoordinate(coordinates[count], problem);
+				count++;
+			}
+
+			uint16_t goal[3];
+			for (unsigned int c = 0; c < count; c++)
+				goal[c] = computeCoordinate(coordinates[c], CubeState());
+
+			uint32_t index = tables.index(phase, values);
+			const uint32_t goalIndex = tables.index(phase, goal);
+			size_t phaseBegin = algorithm.size();
+
+			while (index != goalIndex && found)
+			{
+				const uint8_t closer = (tables.distance(phase, index) + 2) % 3;
+				found = false;
+
+				for (uint8_t m = 0; m < NUM_POSSIBLE_MOVES && !found; m++)
+				{
+					if (!(THISTLETHWAITE_GROUP_MOVES[phase] & (1 << m)))
+						continue;
+
+					for (unsigned int c = 0; c < count; c++)
+						child[c] = moveTables.apply(coordinates[c], values[c], Move(m));
+
+					uint32_t childIndex = tables.index(phase, child);
+					phases[phase].nodes++;
+
+					if (tables.distance(phase, childIndex) == closer)
+					{
+						std::copy(child, child + count, values);
+						index = childIndex;
+						algorithm.push_back(Move(m));
+						problem.applyMoveInPlace(Move(m));
+						found = true;
+					}
+				}
+			}
+
+			auto now = std::chrono::steady_clock::now();
+			std::chrono::duration<double> duration = now - phaseStart;
+			phaseStart = now;
+
+			phases[phase].seconds = duration.count();
+			phases[phase].movesBefore = algorithm.size() - phaseBegin;
+		}
+
+		// No move leads closer from a state that cannot be solved
+		if (!found)
+			algorithm.clear();
+
+		std::queue<Move> solution = optimizeSolution(algorithm);
+
+		if (report != nullptr)
+		{
+			std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+			// Moves merged across the junction of two phases are counted in the later one
+			size_t before = 0, previousAfter = 0;
+			for (PhaseReport &phase : phases)
+			{
+				before += phase.movesBefore;
+				size_t after = found ? optimizeSolution(std::vector<Move>(algorithm.begin(), algorithm.begin() + before)).size() : 0;
+				phase.movesAfter = after - previousAfter;
+				previousAfter = after;
+			}
+
+			report->status = found ? SolveStatus::SOLVED : SolveStatus::NOT_FOUND;
+			report->seconds = duration.count();
+			report->phases = phases;
+			report->peakVisited = 0;
+			report->scratchGrowthBytes = 0;
+			report->scratchBytes = 0;
+		}
+
+		return solution;
+	}
+}
@@ -0,0 +1,156 @@
+#include "cube/threadpool.h"
+
+#include <algorithm>
+
+namespace rubik
+{
+	/**
+	 * @param threads - number of workers, 0 to use one per hardware thread
+	 */
+	ThreadPool::ThreadPool(unsigned int threads) : _job(nullptr), _batch(0), _remaining(0), _active(0), _stopping(false)
+	{
+		threads = workerCount(threads);
+
+		for (unsigned int w = 0; w < threads; w++)
+			_workers.push_back(std::make_unique<Worker>());
+
+		// The calling thread is the first worker
+		for (unsigned int w = 1; w < threads; w++)
+			_threads.emplace_back(&ThreadPool::work, this, w);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_wake.notify_all();
+
+		for (std::thread &thread : _threads)
+			thread.join();
+	}
+
+	/**
+	 * @param threads - number of workers asked for, 0 for one per hardware thread
+	 * @return number of workers of a pool built with it
+	 */
+	unsigned int ThreadPool::workerCount(unsigned int threads)
+	{
+		return threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+	}
+
+	unsigned int ThreadPool::size() const
+	{
+		return _workers.size();
+	}
+
+	/**
+	 * Run the jobs [0, jobCount) and wait for all of them. Contiguous ranges of jobs
+	 * are handed to the workers, which then balance the load by stealing.
+	 * @param jobCount - number of jobs
+	 * @param job - called once per job with the job index and the index of the worker
+	 */
+	void ThreadPool::run(size_t jobCount, const Job &job)
+	{
+		if (jobCount == 0)
+			return;
+
+		const size_t workers = _workers.size();
+
+		for (size_t w = 0; w < workers; w++)
+		{
+			std::lock_guard<std::mutex> lock(_workers[w]->mutex);
+			for (size_t j = w * jobCount / workers; j < (w + 1) * jobCount / workers; j++)
+				_workers[w]->jobs.push_back(j);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_job = &job;
+			_remaining = jobCount;
+			_batch++;
+		}
+		_wake.notify_all();
+
+		size_t index;
+		while (takeJob(0, index))
+		{
+			job(index, 0);
+			_remaining--;
+		}
+
+		// Wait for the workers to leave the batch so none of them can take a job of the
+		// next batch with this job function.
+		std::unique_lock<std::mutex> lock(_mutex);
+		_done.wait(lock, [this]()
+				   { return _remaining == 0 && _active == 0; });
+		_job = nullptr;
+	}
+
+	/**
+	 * Take the next job of a worker or steal one from another worker.
+	 */
+	bool ThreadPool::takeJob(unsigned int worker, size_t &job)
+	{
+		{
+			Worker &own = *_workers[worker];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.jobs.empty())
+			{
+				job = own.jobs.back();
+				own.jobs.pop_back();
+				return true;
+			}
+		}
+
+		for (size_t offset = 1; offset < _workers.size(); offset++)
+		{
+			Worker &victim = *_workers[(worker + offset) % _workers.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.jobs.empty())
+			{
+				job = victim.jobs.front();
+				victim.jobs.pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void ThreadPool::work(unsigned int worker)
+	{
+		uint64_t seenBatch = 0;
+
+		while (true)
+		{
+			const Job *job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_wake.wait(lock, [&]()
+						   { return _stopping || (_job != nullptr && _batch != seenBatch); });
+
+				if (_stopping)
+					return;
+
+				seenBatch = _batch;
+				job = _job;
+				_active++;
+			}
+
+			size_t index;
+			while (takeJob(worker, index))
+			{
+				(*job)(index, worker);
+				_remaining--;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_active--;
+			}
+			_done.notify_all();
+		}
+	}
+}
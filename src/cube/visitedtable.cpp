@@ -0,0 +1,214 @@
+#include "cube/visitedtable.h"
+
+#include <algorithm>
+
+namespace rubik
+{
+	/**
+	 * @param initialCapacity - number of slots to reserve, rounded up to a power of two
+	 */
+	VisitedTable::VisitedTable(size_t initialCapacity) : _size(0), _generation(1), _stats{}
+	{
+		size_t capacity = 16;
+		while (capacity < initialCapacity)
+			capacity <<= 1;
+
+		_entries = std::vector<Entry>(capacity, Entry{0, TKInformation{}, 0});
+		_mask = capacity - 1;
+		_stats.capacity = capacity;
+	}
+
+	/**
+	 * Forget every state while keeping the memory. Only the generation of the
+	 * table changes, so the slots are reset lazily.
+	 */
+	void VisitedTable::clear()
+	{
+		_stats.peakSize = std::max(_stats.peakSize, _size);
+		_size = 0;
+		_generation++;
+
+		// Wrapped around: the old generations could be mistaken for the new one.
+		if (_generation == 0)
+		{
+			for (Entry &entry : _entries)
+				entry.generation = 0;
+			_generation = 1;
+		}
+	}
+
+	/**
+	 * Forget every state and the peak size of the previous searches, so that the
+	 * peak of the next solve is measured alone.
+	 */
+	void VisitedTable::reset()
+	{
+		clear();
+		_stats.peakSize = 0;
+	}
+
+	/**
+	 * Look for a state without inserting it.
+	 * @param metrics - metrics of the state
+	 * @param information - receives the information of the state if it was seen
+	 */
+	bool VisitedTable::find(const TKMetrics &metrics, TKInformation &information) const
+	{
+		uint64_t key = packMetrics(metrics);
+		size_t index = hashMetricsKey(key) & _mask;
+
+		while (_entries[index].generation == _generation)
+		{
+			if (_entries[index].key == key)
+			{
+				information = _entries[index].information;
+				return true;
+			}
+			index = (index + 1) & _mask;
+		}
+
+		return false;
+	}
+
+	size_t VisitedTable::size() const
+	{
+		return _size;
+	}
+
+	size_t VisitedTable::bytes() const
+	{
+		return _entries.capacity() * sizeof(Entry);
+	}
+
+	VisitedTableStats VisitedTable::getStats() const
+	{
+		VisitedTableStats stats = _stats;
+		stats.size = _size;
+		stats.peakSize = std::max(_stats.peakSize, _size);
+		return stats;
+	}
+
+	/**
+	 * Double the number of slots and reinsert the live entries.
+	 */
+	void VisitedTable::grow()
+	{
+		std::vector<Entry> old = std::move(_entries);
+
+		_entries = std::vector<Entry>(old.size() * 2, Entry{0, TKInformation{}, 0});
+		_mask = _entries.size() - 1;
+		_stats.capacity = _entries.size();
+
+		for (const Entry &entry : old)
+		{
+			if (entry.generation != _generation)
+				continue;
+
+			size_t index = hashMetricsKey(entry.key) & _mask;
+			while (_entries[index].generation == _generation)
+				index = (index + 1) & _mask;
+
+			_entries[index] = entry;
+		}
+	}
+
+	ConcurrentVisitedTable::ConcurrentVisitedTable() : _capacity(0), _size(0), _peakSize(0) {}
+
+	/**
+	 * Forget every state, keeping the slots. Not thread-safe.
+	 */
+	void ConcurrentVisitedTable::clear()
+	{
+		_peakSize = std::max(_peakSize, _size.load());
+		_size = 0;
+
+		for (size_t i = 0; i < _capacity; i++)
+			_entries[i].word.store(0, std::memory_order_relaxed);
+	}
+
+	/**
+	 * Forget every state and the peak size of the previous searches. Not thread-safe.
+	 */
+	void ConcurrentVisitedTable::reset()
+	{
+		clear();
+		_peakSize = 0;
+	}
+
+	/**
+	 * Make sure the table stays at most half full with the given number of states.
+	 * Not thread-safe.
+	 * @param expectedSize - number of states the table must be able to hold
+	 */
+	void ConcurrentVisitedTable::reserve(size_t expectedSize)
+	{
+		size_t capacity = std::max<size_t>(_capacity, 1 << 16);
+		while (capacity < 2 * expectedSize)
+			capacity <<= 1;
+
+		if (capacity == _capacity)
+			return;
+
+		std::unique_ptr<Entry[]> old = std::move(_entries);
+		size_t oldCapacity = _capacity;
+
+		_entries = std::make_unique<Entry[]>(capacity);
+		_capacity = capacity;
+
+		for (size_t i = 0; i < capacity; i++)
+			_entries[i].word.store(0, std::memory_order_relaxed);
+
+		for (size_t i = 0; i < oldCapacity; i++)
+		{
+			uint64_t word = old[i].word.load(std::memory_order_relaxed);
+			if (word == 0)
+				continue;
+
+			size_t index = hashMetricsKey(word & KEY_MASK) & (capacity - 1);
+			while (_entries[index].word.load(std::memory_order_relaxed) != 0)
+				index = (index + 1) & (capacity - 1);
+
+			_entries[index].word.store(word, std::memory_order_relaxed);
+			_entries[index].pred = old[i].pred;
+		}
+	}
+
+	bool ConcurrentVisitedTable::find(const TKMetrics &metrics, TKInformation &information) const
+	{
+		uint64_t key = packMetrics(metrics);
+		size_t index = hashMetricsKey(key) & (_capacity - 1);
+
+		while (true)
+		{
+			uint64_t word = _entries[index].word.load(std::memory_order_acquire);
+
+			if (word == 0)
+				return false;
+
+			if ((word & KEY_MASK) == key)
+			{
+				uint64_t pred = _entries[index].pred;
+				information.pred = TKMetrics{uint16_t(pred), uint16_t(pred >> 16), uint16_t(pred >> 32), uint16_t(pred >> 48)};
+				information.directionMove = uint8_t(word >> 56);
+				return true;
+			}
+
+			index = (index + 1) & (_capacity - 1);
+		}
+	}
+
+	size_t ConcurrentVisitedTable::size() const
+	{
+		return _size.load();
+	}
+
+	size_t ConcurrentVisitedTable::peakSize() const
+	{
+		return std::max(_peakSize, _size.load());
+	}
+
+	size_t ConcurrentVisitedTable::bytes() const
+	{
+		return _capacity * sizeof(Entry);
+	}
+}
@@ -9,29 +9,62 @@ namespace parsing
 {
     std::vector<rubik::Move> parseAlgorithm(std::string filePath)
     {
-        std::vector<rubik::Move> algo;
-
         std::ifstream file(filePath);
         if (!file.is_open())
         {
             std::cerr << "ERROR: The given ALGO file (" << filePath << ") cannot be found." << std::endl;
-            return algo;
+            return std::vector<rubik::Move>();
         }
 
+        std::vector<rubik::Move> algo = parseAlgorithm(file, filePath);
+
+        file.close();
+        return algo;
+    }
+
+    /**
+     * Parse a single line of moves, like "R U R' U2".
+     * @param algorithm - moves separated by spaces
+     * @param valid - set to false if a move could not be parsed
+     */
+    std::vector<rubik::Move> parseAlgorithmString(const std::string &algorithm, bool *valid)
+    {
+        std::istringstream stream(algorithm);
+        return parseAlgorithm(stream, "\"" + algorithm + "\"", valid);
+    }
+
+    /**
+     * Parse moves until the end of the stream or the first invalid move.
+     * @param stream - moves separated by whitespace
+     * @param source - name of the stream for the error messages
+     * @param valid - set to false if a move could not be parsed
+     */
+    std::vector<rubik::Move> parseAlgorithm(std::istream &stream, const std::string &source, bool *valid)
+    {
+        std::vector<rubik::Move> algo;
+
         std::string token;
         bool errorDetected = false;
 
         int turn = 0;
         int face = 0;
 
-        while ((file >> token) && !errorDetected)
+        while (!errorDetected && (stream >> token))
         {
             token = trim(token);
-            if (token.length() == 0 || token.length() >= 3)
+            if (token.length() == 0)
             {
                 continue;
             }
 
+            // A longer token is no move, skipping it would turn a different algorithm
+            if (token.length() >= 3)
+            {
+                std::cerr << "ERROR: Move " << token << " parsed from " << source << " is not valid." << std::endl;
+                errorDetected = true;
+                break;
+            }
+
             char lower = static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(token[0])));
 
             switch (lower)
@@ -56,7 +89,7 @@ namespace parsing
                 break;
 
             default:
-                std::cerr << "ERROR: Move " << lower << " parsed from " << filePath << " is not valid." << std::endl;
+                std::cerr << "ERROR: Move " << lower << " parsed from " << source << " is not valid." << std::endl;
                 errorDetected = true;
                 break;
             }
@@ -75,15 +108,18 @@ namespace parsing
             }
             else
             {
-                std::cerr << "ERROR: Move " << token << " parsed from " << filePath << " is not valid." << std::endl;
+                std::cerr << "ERROR: Move " << token << " parsed from " << source << " is not valid." << std::endl;
                 errorDetected = true;
                 break;
             }
 
-            algo.push_back(rubik::Move(face, turn));
+            if (!errorDetected)
+                algo.push_back(rubik::Move(face, turn));
         }
 
-        file.close();
+        if (valid != nullptr)
+            *valid = !errorDetected;
+
         return algo;
     }
 
@@ -2,7 +2,7 @@
 
 int main()
 {
-    Application app = Application::getInstance();
+    Application &app = Application::getInstance();
 
     return app.launch();
 }
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cube/coordinates.h"
+#include "cube/phasesearch.h"
+#include "cube/solver.h"
+
+/**
+ * Checks of the solver run by ctest. Every check prints its result and the program
+ * fails if any of them fails.
+ */
+
+// Allocations made through operator new since the start of the program
+static std::atomic<size_t> allocations = 0;
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+/**
+ * Random moves that never turn the same face twice in a row.
+ */
+static std::vector<rubik::Move> makeScramble(std::mt19937 &random, unsigned int length)
+{
+    std::vector<rubik::Move> scramble;
+    int lastFace = -1;
+
+    while (scramble.size() < length)
+    {
+        rubik::Move move(int(random() % rubik::NUM_POSSIBLE_MOVES));
+        if (move.getFace() == lastFace)
+            continue;
+
+        scramble.push_back(move);
+        lastFace = move.getFace();
+    }
+
+    return scramble;
+}
+
+/**
+ * Turning the cube must never reach the heap.
+ */
+static bool checkMoveAllocations()
+{
+    std::mt19937 random(1);
+    std::vector<rubik::Move> moves = makeScramble(random, 100000);
+
+    rubik::CubeState state;
+    size_t before = allocations;
+
+    for (const rubik::Move &move : moves)
+        state.applyMoveInPlace(move);
+
+    size_t count = allocations - before;
+    if (count != 0)
+    {
+        std::cerr << "applyMoveInPlace: " << count << " allocations for " << moves.size() << " moves" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Once a scratch has grown for a search, searching the same state again must not
+ * allocate until the algorithm is built: the search is stopped halfway so that
+ * only the expansions are counted.
+ * @param name - name of the search in the messages
+ * @param search - search of a phase with a scratch
+ */
+static bool checkSearchAllocations(
+    const std::string &name,
+    const std::function<std::vector<rubik::Move>(const rubik::CubeState &, unsigned int, rubik::SearchScratch &,
+                                                 uint64_t &, const rubik::SearchLimits &)> &search)
+{
+    std::mt19937 random(2);
+    rubik::CubeState state;
+    for (const rubik::Move &move : makeScramble(random, 25))
+        state.applyMoveInPlace(move);
+
+    rubik::SearchScratch scratch;
+    bool success = true;
+    unsigned int stoppedPhases = 0;
+
+    for (unsigned int phase = 0; phase < rubik::THISTLETHWAITE_KOCIEMBA_PHASE_COUNT; phase++)
+    {
+        uint64_t warmNodes = 0;
+        std::vector<rubik::Move> algorithm = search(state, phase, scratch, warmNodes, rubik::SearchLimits());
+
+        // A limit of 0 nodes would not stop the search
+        rubik::SearchLimits limits;
+        limits.maxNodes = std::max<uint64_t>(warmNodes / 2, 1);
+
+        uint64_t nodes = 0;
+        size_t before = allocations;
+        std::vector<rubik::Move> stopped = search(state, phase, scratch, nodes, limits);
+        size_t count = allocations - before;
+
+        // The limits are only checked every few expansions, a small phase ends before
+        if (stopped.empty())
+            stoppedPhases++;
+
+        if (stopped.empty() && count != 0)
+        {
+            std::cerr << name << ": " << count << " allocations for " << nodes << " states of phase " << phase
+                      << std::endl;
+            success = false;
+        }
+
+        for (const rubik::Move &move : algorithm)
+            state.applyMoveInPlace(move);
+    }
+
+    if (stoppedPhases == 0)
+    {
+        std::cerr << name << ": no phase was stopped by the limit" << std::endl;
+        success = false;
+    }
+
+    return success;
+}
+
+/**
+ * The peak of the visited states reported by a solve must only count that solve, even
+ * on a scratch that already solved a harder state.
+ */
+static bool checkPeakPerSolve()
+{
+    std::mt19937 random(4);
+    rubik::CubeState hard, easy;
+    for (const rubik::Move &move : makeScramble(random, 25))
+        hard.applyMoveInPlace(move);
+    easy.applyMoveInPlace(rubik::Move(0));
+
+    rubik::SolveReport alone, hardReport, after;
+    rubik::thistlethwaiteKociemba(easy, rubik::SolverOptions(), nullptr, &alone);
+
+    rubik::SearchScratch scratch;
+    rubik::thistlethwaiteKociemba(hard, rubik::SolverOptions(), nullptr, &hardReport, &scratch);
+    rubik::thistlethwaiteKociemba(easy, rubik::SolverOptions(), nullptr, &after, &scratch);
+
+    if (after.peakVisited != alone.peakVisited)
+    {
+        std::cerr << "peakVisited: " << after.peakVisited << " states after a solve of " << hardReport.peakVisited
+                  << " states, " << alone.peakVisited << " alone" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * The metrics updated through the move tables must match the metrics computed from
+ * the cubies along a random walk of the moves of the phase.
+ * @param steps - number of moves of the walk
+ */
+template <unsigned int Phase>
+static bool checkMetricsWalk(unsigned int steps)
+{
+    const rubik::MoveTables &tables = rubik::MoveTables::getInstance();
+    const rubik::MoveList &legalMoves = rubik::PHASE_MOVE_LISTS<Phase, false>[0];
+
+    std::mt19937 random(3 + Phase);
+    rubik::CubeState state;
+    rubik::TKMetrics metrics = state.thistlethwaiteKociembaId(Phase);
+
+    for (unsigned int step = 0; step < steps; step++)
+    {
+        rubik::Move move(legalMoves.moves[random() % legalMoves.size]);
+
+        state.applyMoveInPlace(move);
+        metrics = tables.updateMetrics<Phase>(metrics, move);
+
+        if (metrics != state.thistlethwaiteKociembaId(Phase))
+        {
+            std::cerr << "updateMetrics<" << Phase << ">: mismatch after " << step + 1 << " moves" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    // The tables are mapped before any check counts the allocations
+    rubik::MoveTables::getInstance();
+
+    struct Check
+    {
+        std::string name;
+        std::function<bool()> run;
+    };
+
+    std::vector<Check> checks = {
+        {"move_allocations", checkMoveAllocations},
+        {"coordinate_search_allocations",
+         []
+         {
+             return checkSearchAllocations("searchPhaseCoordinates",
+                                           [](const rubik::CubeState &state, unsigned int phase,
+                                              rubik::SearchScratch &scratch, uint64_t &nodes,
+                                              const rubik::SearchLimits &limits)
+                                           { return rubik::searchPhaseCoordinates(state, phase, true, scratch, nodes,
+                                                                                  limits); });
+         }},
+        {"layered_search_allocations",
+         []
+         {
+             return checkSearchAllocations("searchPhase",
+                                           [](const rubik::CubeState &state, unsigned int phase,
+                                              rubik::SearchScratch &scratch, uint64_t &nodes,
+                                              const rubik::SearchLimits &limits)
+                                           { return rubik::searchPhase(state, phase, true, scratch, nodes, limits); });
+         }},
+        {"peak_per_solve", checkPeakPerSolve},
+        {"phase_0_metrics_walk", [] { return checkMetricsWalk<0>(120000); }},
+        {"phase_1_metrics_walk", [] { return checkMetricsWalk<1>(120000); }},
+        {"phase_2_metrics_walk", [] { return checkMetricsWalk<2>(120000); }},
+    };
+
+    int failures = 0;
+    for (const Check &check : checks)
+    {
+        bool success = check.run();
+        std::cout << (success ? "[PASS] " : "[FAIL] ") << check.name << std::endl;
+        failures += !success;
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}